@@ -84,7 +84,7 @@ int loop_gui(Search* search_prechecked) {
             ImVec2 results_area_size = ImVec2(search_bar_width, 350.0f);
             ImGui::BeginChild("##SearchResults", results_area_size, true, ImGuiWindowFlags_NoBackground);
 
-            for (const auto& result : Search::SearchResults) {
+            for (const auto& result : Search::PollResults()) {
                 ImGui::Text("%s", result.c_str());
             }
 
@@ -151,8 +151,8 @@ int main() {
 
         loop_gui(search);
 
-        Database::Destroy();
         Search::Destroy();
+        Database::Destroy();
 
         imgui_binding.reset();
         glfw_window.reset();
@@ -161,8 +161,8 @@ int main() {
         return EXIT_SUCCESS;
     } else
     {
-        Database::Destroy();
         Search::Destroy();
+        Database::Destroy();
 
         imgui_binding.reset();
         glfw_window.reset();
@@ -0,0 +1,20 @@
+#pragma once
+
+/*
+* A document is split into chunks of at most MAX_PARAGRAPH_SIZE bytes (see DocumentChunker), and each chunk is stored as a row of Paragraphs.
+* Paragraphs.document_offset is the chunk's byte offset in the document, so the document is its chunks, in order of document_offset.
+*/
+static constexpr char DDL_CREATE_TABLE_IF_NOT_EXISTS_DOCUMENTS[117] = R"(
+CREATE TABLE IF NOT EXISTS Documents (
+    id INTEGER PRIMARY KEY AUTOINCREMENT,
+    text_size INTEGER NOT NULL
+);
+)";
+
+static constexpr char DMC_ANALYZE_DOCUMENTS[25] = R"(
+    ANALYZE Documents;
+)";
+
+static constexpr char DML_INSERT_DOCUMENT[52] = R"(
+    INSERT INTO Documents (text_size) VALUES (?);
+)";
@@ -1,17 +1,27 @@
 #pragma once
 
-static constexpr char DDL_CREATE_TABLE_IF_NOT_EXISTS_PARAGRAPHS[154] = R"(
+static constexpr char DDL_CREATE_TABLE_IF_NOT_EXISTS_PARAGRAPHS[415] = R"(
 CREATE TABLE IF NOT EXISTS Paragraphs (
     id INTEGER PRIMARY KEY AUTOINCREMENT,
+    document_id INTEGER NOT NULL,
+    document_offset INTEGER NOT NULL,
     original_text TEXT NOT NULL,
-    normalized_text TEXT NOT NULL
+    normalized_text TEXT NOT NULL,
+    word_count INTEGER NOT NULL,
+    FOREIGN KEY(document_id) REFERENCES Documents(id) ON DELETE CASCADE
 );
+
+CREATE INDEX IF NOT EXISTS idx_paragraphs_document_id ON Paragraphs(document_id);
 )";
 
 static constexpr char DMC_ANALYZE_PARAGRAPHS[26] = R"(
     ANALYZE Paragraphs;
 )";
 
-static constexpr char DML_INSERT_PARAGRAPH[77] = R"(
-    INSERT INTO Paragraphs (original_text, normalized_text) VALUES (?, ?);
-)";
\ No newline at end of file
+static constexpr char DML_INSERT_PARAGRAPH[128] = R"(
+    INSERT INTO Paragraphs (document_id, document_offset, original_text, normalized_text, word_count) VALUES (?, ?, ?, ?, ?);
+)";
+
+static constexpr char DML_SELECT_PARAGRAPH_STATISTICS[56] = R"(
+    SELECT COUNT(*), AVG(word_count) FROM Paragraphs;
+)";
@@ -1,20 +1,23 @@
 #pragma once
 
-static constexpr char DDL_CREATE_TABLE_IF_NOT_EXISTS_WORDS[166] = R"(
+static constexpr char DDL_CREATE_TABLE_IF_NOT_EXISTS_WORDS[471] = R"(
 CREATE TABLE IF NOT EXISTS Words (
     id INTEGER PRIMARY KEY AUTOINCREMENT,
-    word TEXT NOT NULL UNIQUE
+    word TEXT NOT NULL UNIQUE,
+    reversed_word TEXT NOT NULL,                -- the bytes of word in reverse order, so that words ending with a suffix are a range of the index, like words beginning with a prefix
+    document_frequency INTEGER NOT NULL DEFAULT 0
 );
 
 CREATE INDEX IF NOT EXISTS idx_words ON Words(word);
+CREATE INDEX IF NOT EXISTS idx_words_reversed ON Words(reversed_word);
 )";
 
 static constexpr char DMC_ANALYZE_WORDS[21] = R"(
     ANALYZE Words;
 )";
 
-static constexpr char DML_INSERT_WORD[43] = R"(
-    INSERT INTO Words (word) VALUES (?);
+static constexpr char DML_INSERT_WORD[61] = R"(
+    INSERT INTO Words (word, reversed_word) VALUES (?, ?);
 )";
 
 static constexpr char DML_EXPLAIN_QUERY_PLAN_DML_SELECT_ID_FROM_WORDS_WHERE_WORD_EQUALS[62] = R"(
@@ -32,3 +35,29 @@ static constexpr char DML_EXPLAIN_QUERY_PLAN_DML_SELECT_ID_FROM_WORDS_WHERE_WORD
 static constexpr char DML_SELECT_ID_FROM_WORDS_WHERE_WORD_LIKE[46] = R"(
     SELECT id FROM Words WHERE word LIKE ?;
 )";
+
+static constexpr char DML_EXPLAIN_QUERY_PLAN_DML_SELECT_ID_FROM_WORDS_WHERE_WORD_IN_RANGE[76] = R"(
+    EXPLAIN QUERY PLAN SELECT id FROM Words WHERE word >= ? AND word < ?;
+)";
+
+static constexpr char DML_SELECT_ID_FROM_WORDS_WHERE_WORD_IN_RANGE[57] = R"(
+    SELECT id FROM Words WHERE word >= ? AND word < ?;
+)";
+
+static constexpr char DML_EXPLAIN_QUERY_PLAN_DML_SELECT_ID_FROM_WORDS_WHERE_REVERSED_WORD_IN_RANGE[94] = R"(
+    EXPLAIN QUERY PLAN SELECT id FROM Words WHERE reversed_word >= ? AND reversed_word < ?;
+)";
+
+static constexpr char DML_SELECT_ID_FROM_WORDS_WHERE_REVERSED_WORD_IN_RANGE[75] = R"(
+    SELECT id FROM Words WHERE reversed_word >= ? AND reversed_word < ?;
+)";
+
+static constexpr char DML_SELECT_ID_WORD_FROM_WORDS[34] = R"(
+    SELECT id, word FROM Words;
+)";
+
+static constexpr char DML_UPDATE_WORDS_DOCUMENT_FREQUENCY[145] = R"(
+    UPDATE Words SET document_frequency = (
+        SELECT COUNT(DISTINCT paragraph_id) FROM WordsToParagraphs WHERE word_id = Words.id
+    );
+)";
@@ -0,0 +1,28 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+
+using namespace std;
+
+/*
+* Identifies one generation of a query. 
+* The query is cancelled as soon as a newer generation exists, ie. as soon as the user has typed something that makes its results obsolete.
+*/
+struct CancellationToken
+{
+    CancellationToken() = delete;
+
+    CancellationToken(const atomic<uint64_t>& in_latest_generation, const uint64_t in_generation) noexcept :
+        latest_generation(in_latest_generation),
+        generation(in_generation) {}
+
+    /*
+    * Cheap enough to call from SQLite's progress handler, and from inside loops.
+    */
+    bool isCancelled() const { return latest_generation.load(memory_order_relaxed) != generation; }
+
+    const atomic<uint64_t>& latest_generation;
+
+    const uint64_t generation;
+};
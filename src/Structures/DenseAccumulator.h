@@ -0,0 +1,91 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+#include <algorithm>
+
+using namespace std;
+
+/*
+* A map from small non-negative ids (eg. sqlite rowids, which are dense) to values, stored as an array indexed by id.
+*
+* Each slot is stamped with the epoch that it was last written in, and a slot with an old stamp reads as T().
+* Reset() only increments the epoch, so nothing is cleared, freed or rehashed between uses, and the arrays keep their size.
+* The ids written since the last Reset() are kept in order, for iterating over the values that were set.
+*/
+template<class T>
+class DenseAccumulator
+{
+public:
+    DenseAccumulator() : epoch{1} {}
+
+    DenseAccumulator(const DenseAccumulator&) = delete;
+    DenseAccumulator& operator=(const DenseAccumulator&) = delete;
+
+    /*
+    * Every slot reads as T() again. O(1), except for the one call in 2^32 where the epoch wraps around, which clears the stamps.
+    */
+    void Reset()
+    {
+        touched.clear();
+
+        if (++epoch == 0)
+        {
+            fill(epochs.begin(), epochs.end(), 0);
+            epoch = 1;
+        }
+    }
+
+    /*
+    * Grows the arrays to fit ids up to max_id, so that operator[] doesn't have to.
+    */
+    void Reserve(const int64_t max_id)
+    {
+        if (static_cast<size_t>(max_id) >= values.size())
+        {
+            values.resize(static_cast<size_t>(max_id) + 1);
+            epochs.resize(static_cast<size_t>(max_id) + 1, 0);
+        }
+    }
+
+    /*
+    * The value of id, which is set to T() first if it wasn't written since the last Reset().
+    */
+    T& operator[](const int64_t id)
+    {
+        const size_t i = static_cast<size_t>(id);
+
+        if (i >= values.size())
+        {
+            Reserve(max<int64_t>(id, static_cast<int64_t>(values.size()) * 2));
+        }
+
+        if (epochs[i] != epoch)
+        {
+            epochs[i] = epoch;
+            values[i] = T();
+            touched.push_back(id);
+        }
+        return values[i];
+    }
+
+    /*
+    * The value of id, or T() if it wasn't written since the last Reset(). Doesn't write anything.
+    */
+    T Get(const int64_t id) const
+    {
+        const size_t i = static_cast<size_t>(id);
+        return (i < values.size() && epochs[i] == epoch) ? values[i] : T();
+    }
+
+    /*
+    * The ids written since the last Reset(), in the order that they were first written.
+    */
+    const vector<int64_t>& Touched() const { return touched; }
+
+protected:
+    vector<T> values;
+    vector<uint32_t> epochs;
+    vector<int64_t> touched;
+    uint32_t epoch;
+};
@@ -0,0 +1,52 @@
+#include "DocumentChunker.h"
+
+DocumentChunker::DocumentChunker(const char* in_text, const size_t in_text_size, const size_t in_max_chunk_size) : 
+    chunk{}, chunk_offset{0}, text{in_text}, text_size{in_text_size}, max_chunk_size{in_max_chunk_size}, position{0} {}
+
+bool DocumentChunker::Next()
+{
+    while (position < text_size && text[position] == ' ')
+    {
+        ++position;
+    }
+
+    if (position >= text_size || max_chunk_size == 0)
+    {
+        return false;
+    }
+
+    size_t end = text_size;
+
+    if (text_size - position > max_chunk_size)
+    {
+        end = position + max_chunk_size;
+
+        if (text[end] != ' ')
+        {
+            /*
+            * Back up to the last space in the chunk. If there is none, back up to the start of a UTF-8 character instead.
+            */
+            size_t space = end;
+            while (space > position && text[space - 1] != ' ')
+            {
+                --space;
+            }
+
+            if (space > position)
+            {
+                end = space - 1;
+            } else
+            {
+                while (end > position + 1 && (static_cast<unsigned char>(text[end]) & 0xC0) == 0x80)
+                {
+                    --end;
+                }
+            }
+        }
+    }
+
+    chunk = string_view(text + position, end - position);
+    chunk_offset = position;
+    position = end;
+    return true;
+}
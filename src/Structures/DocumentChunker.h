@@ -0,0 +1,35 @@
+#pragma once
+
+#include <cstddef>
+#include <string_view>
+
+using namespace std;
+
+/*
+* Splits a document of any length into chunks of at most max_chunk_size bytes, which are indexed as paragraphs.
+* 
+* Chunks end at the last space that fits, so words are never split (unless a single word is longer than max_chunk_size, 
+* in which case it's split at a UTF-8 character boundary). The spaces between chunks are dropped.
+* 
+* Chunks are views of the document, so nothing is copied: each chunk can be normalized into the same (reused) NormalizedText 
+* and inserted before the next one is produced, and the normalized form of the whole document never exists at once.
+*/
+class DocumentChunker
+{
+public:
+    DocumentChunker(const char* text, const size_t text_size, const size_t max_chunk_size);
+
+    /*
+    * Advances to the next chunk. Returns false once the document is exhausted.
+    */
+    bool Next();
+
+    string_view chunk;      // valid after Next() returns true
+    size_t chunk_offset;    // byte offset of chunk in the document
+
+protected:
+    const char* text;
+    size_t text_size;
+    size_t max_chunk_size;
+    size_t position;
+};
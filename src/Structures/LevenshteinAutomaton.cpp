@@ -0,0 +1,36 @@
+#include <algorithm>
+
+#include "LevenshteinAutomaton.h"
+
+LevenshteinAutomaton::LevenshteinAutomaton(const string_view in_word, const uint8_t in_max_distance) :
+    word(in_word),
+    max_distance(min<uint8_t>(in_max_distance, LEVENSHTEIN_AUTOMATON_MAX_DISTANCE)) {}
+
+void LevenshteinAutomaton::Start(uint8_t* state) const
+{
+    const uint8_t limit = max_distance + 1;
+
+    for (size_t j = 0; j <= word.size(); ++j)
+    {
+        state[j] = static_cast<uint8_t>(min<size_t>(j, limit));
+    }
+}
+
+bool LevenshteinAutomaton::Step(const uint8_t* state, const char c, uint8_t* next) const
+{
+    const uint8_t limit = max_distance + 1;
+
+    next[0] = min<uint8_t>(state[0] + 1, limit);
+    uint8_t lowest = next[0];
+
+    for (size_t j = 1; j <= word.size(); ++j)
+    {
+        const uint8_t substitution = state[j - 1] + (word[j - 1] != c);     // or a match, if the bytes are equal
+        const uint8_t insertion = state[j] + 1;
+        const uint8_t deletion = next[j - 1] + 1;
+
+        next[j] = min<uint8_t>(min(substitution, min(insertion, deletion)), limit);
+        lowest = min(lowest, next[j]);
+    }
+    return lowest <= max_distance;
+}
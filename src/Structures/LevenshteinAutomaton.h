@@ -0,0 +1,51 @@
+#pragma once
+
+#define LEVENSHTEIN_AUTOMATON_MAX_DISTANCE 3    // distances are stored in a byte, clamped to max_distance + 1
+
+#include <cstdint>
+#include <cstddef>
+#include <string>
+#include <string_view>
+
+using namespace std;
+
+/*
+* Accepts the strings within max_distance edits (insertions, deletions or substitutions of a byte) of a word, one byte at a time,
+* so that it can be run down a trie (or a sorted word list, see SortedVocabulary) and abandon a prefix as soon as no string that starts with it can be accepted.
+*
+* A state is the row of the edit distance table for the bytes read so far: state[j] is the distance between them and the first j bytes of the word.
+* Distances above max_distance are clamped to max_distance + 1, so the number of states is finite (this is the Levenshtein automaton's NFA, simulated a row at a time),
+* and a state can't lead to a match once every entry of its row is above max_distance, since reading more bytes never lowers the row's minimum.
+*
+* States are arrays of StateSize() bytes, owned by the caller, so that the states of a trie walk can be kept on one stack.
+*/
+class LevenshteinAutomaton
+{
+public:
+    LevenshteinAutomaton(const string_view in_word, const uint8_t in_max_distance);
+
+    size_t StateSize() const { return word.size() + 1; }
+
+    uint8_t MaxDistance() const { return max_distance; }
+
+    const string& Word() const { return word; }
+
+    /*
+    * The state before any byte is read.
+    */
+    void Start(uint8_t* state) const;
+
+    /*
+    * Writes the state after reading c in state to next. Returns false if no string can be accepted from next (so it's a dead end).
+    */
+    bool Step(const uint8_t* state, const char c, uint8_t* next) const;
+
+    /*
+    * The distance between the bytes read so far and the word. The bytes are accepted if it's <= MaxDistance().
+    */
+    uint8_t Distance(const uint8_t* state) const { return state[word.size()]; }
+
+protected:
+    string word;
+    uint8_t max_distance;
+};
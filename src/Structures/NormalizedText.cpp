@@ -1,80 +1,449 @@
 #include <tuple>
+#include <cstring>
 
 #include "NormalizedText.h"
+#include "UnicodeFolding.h"
+#include "TokenFilters.h"
 
 
-NormalizedText::NormalizedText(const char* text, const size_t max_text_size) : original_text_size{0}, normalized_text_size{0}, normalized_text{""}
+NormalizedText::NormalizedText() : original_text_size{0}, original_text{""}, normalized_text_size{0}, normalized_text{""} {};
+
+NormalizedText::NormalizedText(const char* text, const size_t max_text_size) : NormalizedText()
 {
+    size_t size = 0;
+
     for (size_t i = 0; i < max_text_size; ++i) 
     {
         if (text[i] == '\0') 
         {
-            original_text_size = i;
+            size = i;
             break;
         }
     }
-    
-    if (original_text_size == 0 || original_text_size > max_text_size)
-    {
-        cerr << "Attempted to normalize some text that was either empty, or too long." << endl;
-        exit(EXIT_FAILURE);
-    } else
-    {
-        original_text = text;
-        F1();
-    }
+
+    Assign(text, size, max_text_size);
 };
 
-NormalizedText::NormalizedText(string text, const size_t max_text_size) : original_text_size{0}, normalized_text_size{0}, normalized_text{""}
+NormalizedText::NormalizedText(string text, const size_t max_text_size) : NormalizedText()
 {
-    size_t size = text.size();
-    
-    if (size == 0 || size > max_text_size)
+    Assign(text.data(), text.size(), max_text_size);
+};
+
+void NormalizedText::Assign(const char* text, const size_t text_size, const size_t max_text_size)
+{
+    if (text_size == 0 || text_size > max_text_size)
     {
         cerr << "Attempted to normalize some text that was either empty, or too long." << endl;
         exit(EXIT_FAILURE);
     } else
     {
-        original_text = text;
-        original_text_size = size;
+        original_text.assign(text, text_size);
+        original_text_size = text_size;
         F1();
     }
 };
 
-inline void NormalizedText::F1()
+/*
+* 16 (SSE2) or 32 (AVX2) bytes of ASCII are lowercased at a time, and the positions of the characters that need special handling
+* (anything other than a letter or digit: spaces, punctuation, and every byte of a non-ASCII character) come out of the same pass as a bitmask. 
+* The bytes between special characters are copied to the output in bulk, so a block that contains none of them (the common case for words 
+* longer than a few letters) is a single load, compare and store.
+* 
+* Only 'A'-'Z' are lowercased here, which is what tolower() does in the "C" locale. Non-ASCII characters are decoded and folded one at a time (see UnicodeFolding.h).
+*/
+#if defined(__AVX2__)
+#include <immintrin.h>
+#define NORMALIZED_TEXT_BLOCK_SIZE (static_cast<size_t>(32))
+#elif defined(__SSE2__)
+#include <emmintrin.h>
+#define NORMALIZED_TEXT_BLOCK_SIZE (static_cast<size_t>(16))
+#endif
+
+#ifdef NORMALIZED_TEXT_BLOCK_SIZE
+/*
+* Writes the block at 'in', lowercased, to 'out'. Returns a bitmask with bit i set if in[i] is a special character.
+*/
+static inline uint32_t LowercaseBlock(const char* in, char* out)
+{
+#if defined(__AVX2__)
+    const __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(in));
+    const __m256i upper = _mm256_and_si256(_mm256_cmpgt_epi8(v, _mm256_set1_epi8('A' - 1)), _mm256_cmpgt_epi8(_mm256_set1_epi8('Z' + 1), v)); // signed compares, so bytes >= 0x80 are never 'upper'
+    _mm256_storeu_si256(reinterpret_cast<__m256i*>(out), _mm256_add_epi8(v, _mm256_and_si256(upper, _mm256_set1_epi8(0x20))));
+
+    const __m256i lower = _mm256_and_si256(_mm256_cmpgt_epi8(v, _mm256_set1_epi8('a' - 1)), _mm256_cmpgt_epi8(_mm256_set1_epi8('z' + 1), v));
+    const __m256i digit = _mm256_and_si256(_mm256_cmpgt_epi8(v, _mm256_set1_epi8('0' - 1)), _mm256_cmpgt_epi8(_mm256_set1_epi8('9' + 1), v));
+    const __m256i ordinary = _mm256_or_si256(_mm256_or_si256(upper, lower), digit);
+    return ~static_cast<uint32_t>(_mm256_movemask_epi8(ordinary));
+#else
+    const __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(in));
+    const __m128i upper = _mm_and_si128(_mm_cmpgt_epi8(v, _mm_set1_epi8('A' - 1)), _mm_cmplt_epi8(v, _mm_set1_epi8('Z' + 1))); // signed compares, so bytes >= 0x80 are never 'upper'
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(out), _mm_add_epi8(v, _mm_and_si128(upper, _mm_set1_epi8(0x20))));
+
+    const __m128i lower = _mm_and_si128(_mm_cmpgt_epi8(v, _mm_set1_epi8('a' - 1)), _mm_cmplt_epi8(v, _mm_set1_epi8('z' + 1)));
+    const __m128i digit = _mm_and_si128(_mm_cmpgt_epi8(v, _mm_set1_epi8('0' - 1)), _mm_cmplt_epi8(v, _mm_set1_epi8('9' + 1)));
+    const __m128i ordinary = _mm_or_si128(_mm_or_si128(upper, lower), digit);
+    return ~static_cast<uint32_t>(_mm_movemask_epi8(ordinary)) & 0xFFFF;
+#endif
+}
+#endif
+
+/*
+* Normalizes in[0, size) into out, which must have room for 3 * size bytes. Returns the number of bytes written.
+* Appends each word's span of out to word_spans, and its span of the original text (offset by raw_base) to original_word_spans.
+*/
+static size_t NormalizeRange(const char* in, const size_t size, const size_t raw_base, char* out, vector<WordSpan>& word_spans, vector<WordSpan>& original_word_spans)
 {
-    string normalized_word = "";
+    size_t o = 0;
+    size_t word_start = 0;
+    size_t raw_word_start = 0;
 
-    for (size_t i = 0; i < original_text_size; ++i) 
+    /*
+    * Runs the token filters over the word in out[word_start, o), and records it. Returns false if the filters dropped the word.
+    */
+    auto EndWord = [&](const size_t raw_end) -> bool
     {
-        if (original_text[i] == '&') 
+        bool stop_word;
+        o = word_start + FilterToken(out + word_start, o - word_start, stop_word);
+
+        if (o == word_start)
         {
-            normalized_text += "and";
-            normalized_word += "and";
-        } else if (original_text[i] == '-' || original_text[i] == '_') 
+            return false;
+        }
+
+        word_spans.push_back(WordSpan{static_cast<uint32_t>(word_start), static_cast<uint32_t>(o - word_start), stop_word});
+        original_word_spans.push_back(WordSpan{static_cast<uint32_t>(raw_base + raw_word_start), static_cast<uint32_t>(raw_end - raw_word_start), false});
+        return true;
+    };
+
+    /*
+    * Handles one special ASCII character, or lowercases one ordinary ASCII character. 
+    * 'next' is where the original text of the next word starts, if c is a separator.
+    * A space (or punctuation, see IsWordSeparator()) ends the current word, unless the word is empty (eg. repeated spaces, or a word made only of '-' and '_').
+    */
+    auto NormalizeAscii = [&](const char c, const size_t i, const size_t next)
+    {
+        if (c == '&') 
+        {
+            out[o++] = 'a';
+            out[o++] = 'n';
+            out[o++] = 'd';
+        } else if (c == '-' || c == '_') 
         {
-            continue;
-        } else if (original_text[i] == ' ') 
+            return;
+        } else if (IsWordSeparator(c)) 
         {
-            if (normalized_text.empty() || normalized_text.back() != ' ') 
+            if (o > word_start && EndWord(i)) 
             {
-                normalized_text += ' ';
-                normalized_words.push_back(normalized_word);
-                normalized_word = "";
+                out[o++] = ' ';
+                word_start = o;
             }
+            raw_word_start = next;
         } else 
         {
-            char normalized_character = static_cast<char>(tolower(original_text[i]));
-            normalized_text += normalized_character;
-            normalized_word += normalized_character;
+            out[o++] = (c >= 'A' && c <= 'Z') ? static_cast<char>(c + ('a' - 'A')) : c;
+        }
+    };
+
+    /*
+    * Handles the character that starts at in[i]. Returns its size in bytes.
+    * A non-ASCII character is replaced by its folded form, whose ASCII characters are then handled like any other (eg. U+00A0 folds to ' ', and ends the word).
+    * Bytes that aren't valid UTF-8 are copied unchanged.
+    */
+    auto Normalize = [&](const size_t i) -> size_t
+    {
+        const char c = in[i];
+
+        if (static_cast<uint8_t>(c) < 0x80)
+        {
+            NormalizeAscii(c, i, i + 1);
+            return 1;
         }
+
+        uint32_t code_point;
+        const size_t length = DecodeUtf8(in + i, size - i, code_point);
+
+        if (length == 0)
+        {
+            out[o++] = c;
+            return 1;
+        }
+
+        const char* folded;
+        size_t folded_size;
+
+        if (!FoldCodePoint(code_point, folded, folded_size))
+        {
+            memcpy(out + o, in + i, length);
+            o += length;
+            return length;
+        }
+
+        for (size_t k = 0; k < folded_size; ++k)
+        {
+            if (static_cast<uint8_t>(folded[k]) < 0x80)
+            {
+                NormalizeAscii(folded[k], i, i); // a word that starts inside a folded character (eg. the "4" of "¼" -> "1 4") spans the whole character
+            } else
+            {
+                out[o++] = folded[k];
+            }
+        }
+        return length;
+    };
+
+    size_t i = 0;
+
+#ifdef NORMALIZED_TEXT_BLOCK_SIZE
+    char lowered[NORMALIZED_TEXT_BLOCK_SIZE];
+
+    while (i + NORMALIZED_TEXT_BLOCK_SIZE <= size)
+    {
+        uint32_t special = LowercaseBlock(in + i, lowered);
+        size_t run_start = 0;
+
+        while (special != 0)
+        {
+            const size_t s = static_cast<size_t>(__builtin_ctz(special));
+
+            memcpy(out + o, lowered + run_start, s - run_start);
+            o += s - run_start;
+
+            run_start = s + Normalize(i + s);
+
+            if (run_start >= NORMALIZED_TEXT_BLOCK_SIZE)
+            {
+                break; // a multi-byte character ran to (or past) the end of the block
+            }
+            special &= ~((static_cast<uint32_t>(1) << run_start) - 1); // skips the continuation bytes of a multi-byte character
+        }
+
+        if (run_start < NORMALIZED_TEXT_BLOCK_SIZE)
+        {
+            memcpy(out + o, lowered + run_start, NORMALIZED_TEXT_BLOCK_SIZE - run_start);
+            o += NORMALIZED_TEXT_BLOCK_SIZE - run_start;
+            i += NORMALIZED_TEXT_BLOCK_SIZE;
+        } else
+        {
+            i += run_start;
+        }
+    }
+#endif
+
+    while (i < size) 
+    {
+        i += Normalize(i);
     }
 
-    if (!normalized_word.empty() && normalized_word != " ") 
+    if (o > word_start) 
     {
-        normalized_words.push_back(normalized_word);
+        EndWord(size);
     }
 
-    normalized_text_size = normalized_text.size();
+    return o;
+}
+
+inline void NormalizedText::F1()
+{
+    /*
+    * The output is written to one preallocated buffer, which is trimmed at the end.
+    * Worst case, every character is '&', which is normalized to "and".
+    */
+    normalized_text.resize(original_text_size * 3);
+    word_spans.clear();
+    original_word_spans.clear();
+
+    normalized_text_size = NormalizeRange(original_text.data(), original_text_size, 0, &normalized_text[0], word_spans, original_word_spans);
+    normalized_text.resize(normalized_text_size);
 };
 
+TextEdit NormalizedText::Edit(const char* text, const size_t text_size, const size_t max_text_size)
+{
+    const size_t nOldWords = word_spans.size();
+
+    if (text_size > max_text_size)
+    {
+        cerr << "Attempted to normalize some text that was too long." << endl;
+        exit(EXIT_FAILURE);
+    }
+
+    if (text_size == 0)
+    {
+        original_text.clear();
+        original_text_size = 0;
+        normalized_text.clear();
+        normalized_text_size = 0;
+        word_spans.clear();
+        original_word_spans.clear();
+        return TextEdit{0, nOldWords, 0};
+    }
+
+    if (original_text_size == 0)
+    {
+        Assign(text, text_size, max_text_size);
+        return TextEdit{0, 0, word_spans.size()};
+    }
+
+    const char* old_text = original_text.data();
+    const size_t old_size = original_text_size;
+
+    /*
+    * The bytes that changed are [prefix, old_size - suffix) of the old text, and [prefix, text_size - suffix) of the new text.
+    */
+    const size_t max_common = min(old_size, text_size);
+
+    size_t prefix = 0;
+    while (prefix < max_common && old_text[prefix] == text[prefix])
+    {
+        ++prefix;
+    }
+
+    if (prefix == old_size && old_size == text_size)
+    {
+        return TextEdit{0, 0, 0};
+    }
+
+    size_t suffix = 0;
+    while (suffix < max_common - prefix && old_text[old_size - 1 - suffix] == text[text_size - 1 - suffix])
+    {
+        ++suffix;
+    }
+
+    /*
+    * Every word is normalized on its own, so only the words that overlap the changed bytes can be different.
+    * Widen the change to whole words: back to the space before it, and forwards to the space after it.
+    */
+    size_t start = prefix;
+    while (start > 0 && text[start - 1] != ' ')
+    {
+        --start;
+    }
+
+    size_t old_end = old_size - suffix;
+    while (old_end < old_size && old_text[old_end] != ' ')
+    {
+        ++old_end;
+    }
+    const size_t new_end = text_size - (old_size - old_end);
+
+    /*
+    * Old words [w0, w1) overlap the change. 
+    * start and old_end are both at the edges of space-delimited runs, so a word is inside [start, old_end) if its span starts inside it
+    * (a character that folds to several words, eg. "¼" -> "1 4", can give the first of them an empty span at the start of the character).
+    */
+    size_t w0 = 0;
+    while (w0 < nOldWords && original_word_spans[w0].offset < start)
+    {
+        ++w0;
+    }
+
+    size_t w1 = w0;
+    while (w1 < nOldWords && original_word_spans[w1].offset < old_end)
+    {
+        ++w1;
+    }
+
+    /*
+    * Normalize the changed words of the new text on their own.
+    */
+    edit_text.resize((new_end - start) * 3);
+    edit_word_spans.clear();
+    edit_original_word_spans.clear();
+    NormalizeRange(text + start, new_end - start, start, &edit_text[0], edit_word_spans, edit_original_word_spans);
+
+    auto EditWord = [this](const size_t i) { return string_view(edit_text.data() + edit_word_spans[i].offset, edit_word_spans[i].length); };
+
+    const size_t nRemoved = w1 - w0;
+    const size_t nInserted = edit_word_spans.size();
+    const size_t nCommon = min(nRemoved, nInserted);
+
+    /*
+    * Widening to whole words can include words that didn't change (eg. a space typed after a word). Leave them out of the report.
+    */
+    size_t front = 0;
+    while (front < nCommon && word(w0 + front) == EditWord(front))
+    {
+        ++front;
+    }
+
+    size_t back = 0;
+    while (back < nCommon - front && word(w1 - 1 - back) == EditWord(nInserted - 1 - back))
+    {
+        ++back;
+    }
+
+    /*
+    * Splice the new words into normalized_text: [unchanged words before w0][new words][unchanged words from w1 onwards].
+    * Words are separated by single spaces, and the last word is followed by a space only if the original text has a space after it.
+    */
+    const size_t prefix_end = (w0 > 0) ? word_spans[w0 - 1].offset + word_spans[w0 - 1].length + 1 : 0;
+    const bool has_suffix_words = w1 < nOldWords;
+    const size_t suffix_begin = has_suffix_words ? word_spans[w1].offset : normalized_text_size;
+    const size_t suffix_size = has_suffix_words ? normalized_text_size - suffix_begin : 0;
+
+    size_t middle_size = 0;
+    for (const WordSpan& span : edit_word_spans)
+    {
+        middle_size += span.length + 1;
+    }
+
+    if (!has_suffix_words && nInserted > 0)
+    {
+        const WordSpan& last = edit_original_word_spans.back();
+        if (last.offset + last.length == text_size)
+        {
+            --middle_size; // no space after the last word
+        }
+    }
+
+    const size_t new_normalized_size = prefix_end + middle_size + suffix_size;
+
+    if (new_normalized_size > normalized_text_size)
+    {
+        normalized_text.resize(new_normalized_size);
+    }
+
+    if (suffix_size > 0 && prefix_end + middle_size != suffix_begin)
+    {
+        memmove(&normalized_text[prefix_end + middle_size], &normalized_text[suffix_begin], suffix_size);
+    }
+
+    size_t o = prefix_end;
+    for (size_t i = 0; i < nInserted; ++i)
+    {
+        const WordSpan& span = edit_word_spans[i];
+        memcpy(&normalized_text[o], edit_text.data() + span.offset, span.length);
+
+        edit_word_spans[i].offset = static_cast<uint32_t>(o);
+        o += span.length;
+
+        if (o < prefix_end + middle_size)
+        {
+            normalized_text[o++] = ' ';
+        }
+    }
+
+    normalized_text.resize(new_normalized_size);
+    normalized_text_size = new_normalized_size;
+
+    /*
+    * Shift the spans of the unchanged words after the edit, and swap in the spans of the new words.
+    */
+    const int64_t normalized_shift = static_cast<int64_t>(prefix_end + middle_size) - static_cast<int64_t>(suffix_begin);
+    const int64_t original_shift = static_cast<int64_t>(text_size) - static_cast<int64_t>(old_size);
+
+    for (size_t i = w1; i < nOldWords; ++i)
+    {
+        word_spans[i].offset = static_cast<uint32_t>(word_spans[i].offset + normalized_shift);
+        original_word_spans[i].offset = static_cast<uint32_t>(original_word_spans[i].offset + original_shift);
+    }
+
+    word_spans.erase(word_spans.begin() + w0, word_spans.begin() + w1);
+    word_spans.insert(word_spans.begin() + w0, edit_word_spans.begin(), edit_word_spans.end());
+    original_word_spans.erase(original_word_spans.begin() + w0, original_word_spans.begin() + w1);
+    original_word_spans.insert(original_word_spans.begin() + w0, edit_original_word_spans.begin(), edit_original_word_spans.end());
+
+    original_text.assign(text, text_size);
+    original_text_size = text_size;
+
+    return TextEdit{w0 + front, nRemoved - front - back, nInserted - front - back};
+};
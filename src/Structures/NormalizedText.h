@@ -2,17 +2,60 @@
 
 #include <iostream>
 #include <vector>
+#include <string_view>
 
 using namespace std;
 
+/*
+* A word, as a span of NormalizedText::normalized_text.
+*/
+struct WordSpan
+{
+    uint32_t offset;
+    uint32_t length;
+    bool stop_word; // see TokenFilters.h. Only set in NormalizedText::word_spans
+};
+
+/*
+* Returned by NormalizedText::Edit().
+* Words [first_word, first_word + removed_words) of the previous text were replaced by words [first_word, first_word + inserted_words) of the new text.
+* Every other word is unchanged. The words after the edit moved by (inserted_words - removed_words) positions.
+*/
+struct TextEdit
+{
+    size_t first_word;
+    size_t removed_words;
+    size_t inserted_words;
+
+    bool changed() const { return removed_words != 0 || inserted_words != 0; }
+};
+
 struct NormalizedText
 {
-    NormalizedText() = delete;
+    /*
+    * An empty text, to be filled in with Assign().
+    */
+    NormalizedText();
 
     NormalizedText(const char* text, const size_t max_text_size);
 
     NormalizedText(string text, const size_t max_text_size);
 
+    /*
+    * Normalizes new text into this object's existing buffers. 
+    * Once the buffers have grown to fit the longest text they're used for, this doesn't allocate.
+    */
+    void Assign(const char* text, const size_t text_size, const size_t max_text_size);
+
+    /*
+    * Replaces the text, but only re-normalizes the words around the bytes that changed, and reports which words changed.
+    * The result is the same as Assign(), except that text_size may be 0.
+    * 
+    * The change is found by comparing the new text with the previous text (common prefix and suffix), rather than from 
+    * the position of a single edit, so that several coalesced edits can be applied at once.
+    */
+    TextEdit Edit(const char* text, const size_t text_size, const size_t max_text_size);
+
     size_t original_text_size;
 
     string original_text;
@@ -21,7 +64,38 @@ struct NormalizedText
 
     string normalized_text;
 
-    vector<string> normalized_words;
+    /*
+    * The words of normalized_text, in order. normalized_text holds every word, separated by single spaces, 
+    * so the words don't need their own strings.
+    */
+    vector<WordSpan> word_spans;
+
+    /*
+    * The span of original_text that each word was normalized from, ie. the text between the spaces around it.
+    */
+    vector<WordSpan> original_word_spans;
+
+    size_t wordCount() const { return word_spans.size(); }
+
+    /*
+    * Valid until the next call to Assign() or Edit().
+    */
+    string_view word(const size_t i) const { return string_view(normalized_text.data() + word_spans[i].offset, word_spans[i].length); }
+
+    bool isStopWord(const size_t i) const { return word_spans[i].stop_word; }
+
+    /*
+    * False while the last word may still be typed, ie. if the text doesn't end with a space or punctuation after the last word.
+    */
+    bool isLastWordComplete() const { return normalized_text_size > 0 && normalized_text[normalized_text_size - 1] == ' '; }
 
     inline void F1();
+
+protected:
+    /*
+    * Scratch buffers for Edit(), kept so that their capacity is reused.
+    */
+    string edit_text;
+    vector<WordSpan> edit_word_spans;
+    vector<WordSpan> edit_original_word_spans;
 };
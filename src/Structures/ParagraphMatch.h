@@ -0,0 +1,37 @@
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+using namespace std;
+
+/*
+* One paragraph that contains a matched word, as returned by Database::GetAll_ParagraphId_ParagraphOriginalText_MatchedWordId_OrderedWordsInParagraphIds().
+* The statistics are stored at ingest time, so that a paragraph can be scored without any further queries.
+*/
+struct ParagraphMatch
+{
+    int64_t paragraph_id;
+    string original_text;
+    int64_t matched_word_id;                    // the lowest id of matched_word_ids
+    vector<int64_t> word_ids;                   // all of the word ids in the paragraph, in the order that they occur in that paragraph
+    int64_t document_id;                        // the document that the paragraph is a chunk of
+    uint32_t word_count;                        // Paragraphs.word_count - the paragraph's length, for BM25's length normalization
+    uint32_t matched_word_document_frequency;   // the highest Words.document_frequency of the matched words - a lower bound of the number of paragraphs that contain any of them
+    vector<int64_t> matched_word_ids;           // every word of the paragraph that matched (eg. both "summer" and "summit" for "summ"), in increasing order
+
+    /*
+    * The number of times any of the matched words occurs in the paragraph.
+    */
+    uint32_t MatchedWordFrequency() const
+    {
+        uint32_t frequency = 0;
+        for (const int64_t word_id : word_ids)
+        {
+            frequency += binary_search(matched_word_ids.begin(), matched_word_ids.end(), word_id);
+        }
+        return frequency;
+    }
+};
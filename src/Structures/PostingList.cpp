@@ -0,0 +1,243 @@
+#include <algorithm>
+#include <array>
+
+#include "PostingList.h"
+
+/*
+* The SSSE3 decoder is compiled for SSSE3 regardless of the compiler flags (with a target attribute), since the default x86-64 target only has SSE2,
+* and only called if the CPU has SSSE3.
+*/
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#include <tmmintrin.h>
+#define POSTING_LIST_RUNTIME_DISPATCH
+#endif
+
+/*
+* Bits 2k and 2k+1 of a control byte are the length - 1 of the k'th delta of its group.
+*/
+static inline size_t DeltaLength(const uint32_t delta)
+{
+    return (delta < (1u << 8)) ? 1 : (delta < (1u << 16)) ? 2 : (delta < (1u << 24)) ? 3 : 4;
+}
+
+#ifdef POSTING_LIST_RUNTIME_DISPATCH
+struct StreamVByteTables
+{
+    array<array<uint8_t, 16>, 256> shuffle;    // moves each delta's bytes to the low bytes of its 32 bit lane, and zeroes the rest
+    array<uint8_t, 256> length;                 // the total length of the group's deltas
+};
+
+static constexpr StreamVByteTables MakeStreamVByteTables()
+{
+    StreamVByteTables tables = {};
+
+    for (size_t control = 0; control < 256; ++control)
+    {
+        uint8_t byte = 0;
+
+        for (size_t k = 0; k < 4; ++k)
+        {
+            const size_t length = ((control >> (2 * k)) & 0x3) + 1;
+
+            for (size_t i = 0; i < 4; ++i)
+            {
+                tables.shuffle[control][4 * k + i] = (i < length) ? byte++ : 0xFF;
+            }
+        }
+        tables.length[control] = byte;
+    }
+    return tables;
+}
+
+static constexpr StreamVByteTables STREAM_VBYTE_TABLES = MakeStreamVByteTables();
+#endif
+
+PostingList::PostingList(const uint32_t* ids, const size_t size) : count{size}
+{
+    const size_t nBlocks = (size + POSTING_LIST_BLOCK_SIZE - 1) / POSTING_LIST_BLOCK_SIZE;
+    blocks.reserve(nBlocks);
+    bytes.reserve(size + size / 4 + 16);
+
+    uint32_t previous = 0;
+
+    for (size_t b = 0; b < nBlocks; ++b)
+    {
+        const size_t first = b * POSTING_LIST_BLOCK_SIZE;
+        const size_t last = min(first + POSTING_LIST_BLOCK_SIZE, size);
+        const size_t nGroups = (last - first + 3) / 4;
+
+        blocks.push_back(BlockEntry{ids[last - 1], static_cast<uint32_t>(bytes.size())});
+
+        /*
+        * The last group of the list is padded with zero deltas, which decode past the end of the list and are never read.
+        */
+        const size_t controls = bytes.size();
+        bytes.resize(bytes.size() + nGroups, 0);
+
+        for (size_t i = first; i < first + nGroups * 4; ++i)
+        {
+            const uint32_t delta = (i < last) ? ids[i] - previous : 0;
+            const size_t length = DeltaLength(delta);
+
+            bytes[controls + (i - first) / 4] |= static_cast<uint8_t>((length - 1) << (2 * ((i - first) % 4)));
+
+            for (size_t k = 0; k < length; ++k)
+            {
+                bytes.push_back(static_cast<uint8_t>(delta >> (8 * k)));
+            }
+
+            if (i < last)
+            {
+                previous = ids[i];
+            }
+        }
+    }
+
+    bytes.resize(bytes.size() + 16, 0);
+}
+
+/*
+* Decodes nGroups groups of 4 deltas (their control bytes, then their delta bytes) on top of previous, one delta at a time.
+*/
+static void DecodeGroupsScalar(const uint8_t* controls, const uint8_t* data, const size_t nGroups, uint32_t previous, uint32_t* out)
+{
+    for (size_t g = 0; g < nGroups; ++g)
+    {
+        const uint8_t control = controls[g];
+
+        for (size_t k = 0; k < 4; ++k)
+        {
+            const size_t length = ((control >> (2 * k)) & 0x3) + 1;
+            uint32_t delta = 0;
+
+            for (size_t i = 0; i < length; ++i)
+            {
+                delta |= static_cast<uint32_t>(data[i]) << (8 * i);
+            }
+            data += length;
+
+            previous += delta;
+            out[4 * g + k] = previous;
+        }
+    }
+}
+
+#ifdef POSTING_LIST_RUNTIME_DISPATCH
+/*
+* As DecodeGroupsScalar(), a group at a time.
+*/
+__attribute__((target("ssse3")))
+static void DecodeGroupsSSSE3(const uint8_t* controls, const uint8_t* data, const size_t nGroups, const uint32_t previous, uint32_t* out)
+{
+    __m128i base = _mm_set1_epi32(static_cast<int>(previous));
+
+    for (size_t g = 0; g < nGroups; ++g)
+    {
+        const uint8_t control = controls[g];
+
+        /*
+        * Unpack the 4 deltas, then add them up (prefix sum across the lanes) on top of the previous id.
+        */
+        __m128i ids = _mm_shuffle_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i*>(data)), _mm_loadu_si128(reinterpret_cast<const __m128i*>(STREAM_VBYTE_TABLES.shuffle[control].data())));
+        ids = _mm_add_epi32(ids, _mm_slli_si128(ids, 4));
+        ids = _mm_add_epi32(ids, _mm_slli_si128(ids, 8));
+        ids = _mm_add_epi32(ids, base);
+
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(out + 4 * g), ids);
+
+        base = _mm_shuffle_epi32(ids, 0xFF);
+        data += STREAM_VBYTE_TABLES.length[control];
+    }
+}
+
+/*
+* Checked on first use, so CPU detection never runs before static initialization.
+*/
+static bool HasSSSE3()
+{
+    static const bool supported = []
+    {
+        __builtin_cpu_init();
+        return __builtin_cpu_supports("ssse3") != 0;
+    }();
+    return supported;
+}
+#endif
+
+size_t PostingList::DecodeBlock(const size_t b, uint32_t* out) const
+{
+    const size_t first = b * POSTING_LIST_BLOCK_SIZE;
+    const size_t n = min(POSTING_LIST_BLOCK_SIZE, count - first);
+    const size_t nGroups = (n + 3) / 4;
+
+    const uint8_t* controls = bytes.data() + blocks[b].offset;
+    const uint8_t* data = controls + nGroups;
+    const uint32_t previous = (b == 0) ? 0 : blocks[b - 1].last_id;
+
+#ifdef POSTING_LIST_RUNTIME_DISPATCH
+    if (HasSSSE3())
+    {
+        DecodeGroupsSSSE3(controls, data, nGroups, previous, out);
+        return n;
+    }
+#endif
+    DecodeGroupsScalar(controls, data, nGroups, previous, out);
+    return n;
+}
+
+PostingList::Cursor::Cursor(const PostingList& in_list) : list{&in_list}, block{0}, index{0}
+{
+    if (!list->empty())
+    {
+        LoadBlock(0);
+    }
+}
+
+void PostingList::Cursor::LoadBlock(const size_t b)
+{
+    block = b;
+    list->DecodeBlock(b, buffer);
+}
+
+void PostingList::Cursor::Next()
+{
+    ++index;
+
+    if (index % POSTING_LIST_BLOCK_SIZE == 0 && index < list->count)
+    {
+        LoadBlock(index / POSTING_LIST_BLOCK_SIZE);
+    }
+}
+
+void PostingList::Cursor::SkipTo(const uint32_t target)
+{
+    if (AtEnd() || Value() >= target)
+    {
+        return;
+    }
+
+    /*
+    * The first block (from the current one) whose last id is >= target.
+    */
+    if (list->blocks[block].last_id < target)
+    {
+        const auto next = lower_bound(list->blocks.begin() + block + 1, list->blocks.end(), target,
+            [](const BlockEntry& entry, const uint32_t id) { return entry.last_id < id; });
+
+        if (next == list->blocks.end())
+        {
+            index = list->count;
+            return;
+        }
+
+        LoadBlock(static_cast<size_t>(next - list->blocks.begin()));
+        index = block * POSTING_LIST_BLOCK_SIZE;
+    }
+
+    /*
+    * The block contains an id >= target, so this stops inside the block.
+    */
+    const size_t first = block * POSTING_LIST_BLOCK_SIZE;
+    const size_t n = min(POSTING_LIST_BLOCK_SIZE, list->count - first);
+    index = first + static_cast<size_t>(lower_bound(buffer + (index - first), buffer + n, target) - buffer);
+}
@@ -0,0 +1,93 @@
+#pragma once
+
+#include <cstdint>
+#include <cstddef>
+#include <vector>
+
+#define POSTING_LIST_BLOCK_SIZE (static_cast<size_t>(128)) // ids per block. A multiple of 4, since Stream VByte encodes ids in groups of 4
+
+using namespace std;
+
+/*
+* A compressed list of strictly increasing ids (eg. the paragraph ids that a word occurs in), at ~1-2 bytes per id instead of 8.
+*
+* Ids are delta encoded, and the deltas are stored with Stream VByte: each group of 4 deltas has a control byte that holds their lengths (1 to 4 bytes),
+* and the control bytes are stored apart from the delta bytes, so that a group is decoded with a single shuffle (SSSE3, if the CPU has it) instead of a byte-by-byte loop.
+*
+* The ids are split into blocks of POSTING_LIST_BLOCK_SIZE. Each block has a skip entry with its last id and the offset of its bytes,
+* so that a Cursor can jump past blocks that can't contain the id it's looking for without decoding them.
+*/
+class PostingList
+{
+public:
+    PostingList() : count{0} {}
+
+    /*
+    * ids must be strictly increasing.
+    */
+    PostingList(const uint32_t* ids, const size_t size);
+
+    size_t size() const { return count; }
+
+    bool empty() const { return count == 0; }
+
+    /*
+    * Bytes used by the encoded ids and the skip entries.
+    */
+    size_t MemoryUsage() const { return bytes.size() + blocks.size() * sizeof(BlockEntry); }
+
+    /*
+    * Decodes block b into out, which must have room for POSTING_LIST_BLOCK_SIZE ids. Returns the number of ids in the block.
+    */
+    size_t DecodeBlock(const size_t b, uint32_t* out) const;
+
+    /*
+    * Walks a PostingList in order, decoding one block at a time.
+    */
+    class Cursor
+    {
+    public:
+        Cursor() : list{nullptr}, block{0}, index{0} {}
+
+        Cursor(const PostingList& in_list);
+
+        bool AtEnd() const { return index >= list->count; }
+
+        /*
+        * The id at the cursor. Not valid if AtEnd().
+        */
+        uint32_t Value() const { return buffer[index % POSTING_LIST_BLOCK_SIZE]; }
+
+        /*
+        * The position of the cursor in the list, eg. to look up the data that goes with the id.
+        */
+        size_t Index() const { return index; }
+
+        void Next();
+
+        /*
+        * Moves forward to the first id >= target (or to the end). Never moves backward.
+        * Blocks whose last id is < target are skipped using their skip entries, without being decoded.
+        */
+        void SkipTo(const uint32_t target);
+
+    protected:
+        const PostingList* list;
+        size_t block;               // the block that's decoded in buffer
+        size_t index;
+        alignas(16) uint32_t buffer[POSTING_LIST_BLOCK_SIZE];
+
+        void LoadBlock(const size_t b);
+    };
+
+protected:
+    struct BlockEntry
+    {
+        uint32_t last_id;   // also the id that the next block's deltas start from
+        uint32_t offset;    // of the block's control bytes in bytes. The block's delta bytes follow them
+    };
+
+    size_t count;
+    vector<BlockEntry> blocks;
+    vector<uint8_t> bytes;  // padded with 16 zero bytes, so that the SIMD decoder can always load 16 bytes
+};
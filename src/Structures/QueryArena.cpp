@@ -0,0 +1,66 @@
+#include <algorithm>
+
+#include "QueryArena.h"
+
+/*
+* Not zeroed, since every byte is written by whatever is allocated in it.
+*/
+QueryArena::Chunk QueryArena::NewChunk(const size_t size)
+{
+    return Chunk{unique_ptr<unsigned char[]>(new unsigned char[size]), size};
+}
+
+QueryArena::QueryArena(const size_t initial_size) : current{0}, offset{0}, used{0}
+{
+    chunks.push_back(NewChunk(initial_size));
+}
+
+void QueryArena::Reset()
+{
+    if (chunks.size() > 1)
+    {
+        const size_t size = Capacity();
+
+        chunks.clear();
+        chunks.push_back(NewChunk(size));
+    }
+
+    current = 0;
+    offset = 0;
+    used = 0;
+}
+
+size_t QueryArena::Capacity() const
+{
+    size_t capacity = 0;
+    for (const Chunk& chunk : chunks)
+    {
+        capacity += chunk.size;
+    }
+    return capacity;
+}
+
+void* QueryArena::do_allocate(size_t bytes, size_t alignment)
+{
+    while (true)
+    {
+        Chunk& chunk = chunks[current];
+
+        const uintptr_t base = reinterpret_cast<uintptr_t>(chunk.data.get());
+        const uintptr_t aligned = (base + offset + alignment - 1) & ~static_cast<uintptr_t>(alignment - 1);
+        const size_t end = static_cast<size_t>(aligned - base) + bytes;
+
+        if (end <= chunk.size)
+        {
+            used += end - offset;
+            offset = end;
+            return reinterpret_cast<void*>(aligned);
+        }
+
+        const size_t size = max(2 * chunk.size, bytes + alignment);
+        chunks.push_back(NewChunk(size));
+
+        ++current;
+        offset = 0;
+    }
+}
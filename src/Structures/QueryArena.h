@@ -0,0 +1,59 @@
+#pragma once
+
+#define QUERY_ARENA_INITIAL_SIZE (static_cast<size_t>(64 * 1024))  // bytes. The arena grows past this if a query needs more, and keeps the memory for the next query
+
+#include <cstdint>
+#include <cstddef>
+#include <memory>
+#include <memory_resource>
+#include <vector>
+
+using namespace std;
+
+/*
+* A monotonic memory resource for the short-lived allocations of one query (eg. the ranking's cursors, heaps and sorted results),
+* for pmr containers: pmr::vector<T> v(&arena).
+*
+* Allocation bumps a pointer, deallocation does nothing, and Reset() frees everything at once by rewinding the pointer.
+* Unlike pmr::monotonic_buffer_resource::release(), Reset() keeps the memory: if a query outgrew the arena, its chunks are merged into
+* one chunk that big, so that the next query (which needs about as much) doesn't call malloc or free at all.
+*
+* Not thread safe. Nothing allocated from the arena may be used after Reset().
+*/
+class QueryArena : public pmr::memory_resource
+{
+public:
+    QueryArena(const size_t initial_size = QUERY_ARENA_INITIAL_SIZE);
+
+    QueryArena(const QueryArena&) = delete;
+    QueryArena& operator=(const QueryArena&) = delete;
+
+    void Reset();
+
+    /*
+    * Bytes allocated since the last Reset(), including alignment padding.
+    */
+    size_t BytesUsed() const { return used; }
+
+    size_t Capacity() const;
+
+protected:
+    void* do_allocate(size_t bytes, size_t alignment) override;
+
+    void do_deallocate(void*, size_t, size_t) override {}   // only Reset() frees memory
+
+    bool do_is_equal(const pmr::memory_resource& other) const noexcept override { return this == &other; }
+
+    struct Chunk
+    {
+        unique_ptr<unsigned char[]> data;
+        size_t size;
+    };
+
+    static Chunk NewChunk(const size_t size);
+
+    vector<Chunk> chunks;   // never empty. There is more than one only after a query outgrew the arena, until the next Reset()
+    size_t current;         // the chunk being allocated from
+    size_t offset;          // of the next free byte of chunks[current]
+    size_t used;
+};
@@ -0,0 +1,255 @@
+#include <algorithm>
+
+#include "RoaringBitmap.h"
+#include "SortedSetKernels.h"
+
+#define ROARING_BITMAP_WORDS (static_cast<size_t>(1024))   // 65536 bits
+
+RoaringBitmap::RoaringBitmap(const uint32_t* ids, const size_t size)
+{
+    size_t i = 0;
+
+    while (i < size)
+    {
+        Container container;
+        container.key = static_cast<uint16_t>(ids[i] >> 16);
+
+        size_t end = i;
+        while (end < size && (ids[end] >> 16) == container.key)
+        {
+            ++end;
+        }
+
+        container.cardinality = static_cast<uint32_t>(end - i);
+        container.array.reserve(end - i);
+        for (; i < end; ++i)
+        {
+            container.array.push_back(static_cast<uint16_t>(ids[i]));
+        }
+
+        if (container.cardinality > ROARING_BITMAP_ARRAY_MAX_SIZE)
+        {
+            container.ToBitmap();
+        }
+        containers.push_back(std::move(container));
+    }
+}
+
+bool RoaringBitmap::Contains(const uint32_t id) const
+{
+    const uint16_t key = static_cast<uint16_t>(id >> 16);
+
+    const auto container = lower_bound(containers.begin(), containers.end(), key, [](const Container& c, const uint16_t k) { return c.key < k; });
+
+    return container != containers.end() && container->key == key && container->Contains(static_cast<uint16_t>(id));
+}
+
+size_t RoaringBitmap::Cardinality() const
+{
+    size_t cardinality = 0;
+    for (const Container& container : containers)
+    {
+        cardinality += container.cardinality;
+    }
+    return cardinality;
+}
+
+size_t RoaringBitmap::MemoryUsage() const
+{
+    size_t bytes = containers.capacity() * sizeof(Container);
+    for (const Container& container : containers)
+    {
+        bytes += container.array.capacity() * sizeof(uint16_t) + container.bitmap.capacity() * sizeof(uint64_t);
+    }
+    return bytes;
+}
+
+void RoaringBitmap::And(const RoaringBitmap& other)
+{
+    /*
+    * Only containers with a key in both sets can have ids in the result.
+    */
+    size_t kept = 0;
+    size_t j = 0;
+
+    for (size_t i = 0; i < containers.size(); ++i)
+    {
+        while (j < other.containers.size() && other.containers[j].key < containers[i].key)
+        {
+            ++j;
+        }
+
+        if (j < other.containers.size() && other.containers[j].key == containers[i].key)
+        {
+            containers[i].And(other.containers[j]);
+
+            if (containers[i].cardinality > 0)
+            {
+                if (kept != i)
+                {
+                    containers[kept] = std::move(containers[i]);
+                }
+                ++kept;
+            }
+        }
+    }
+    containers.resize(kept);
+}
+
+void RoaringBitmap::Or(const RoaringBitmap& other)
+{
+    vector<Container> merged;
+    merged.reserve(containers.size() + other.containers.size());
+
+    size_t i = 0;
+    size_t j = 0;
+
+    while (i < containers.size() || j < other.containers.size())
+    {
+        if (j == other.containers.size() || (i < containers.size() && containers[i].key < other.containers[j].key))
+        {
+            merged.push_back(std::move(containers[i++]));
+        } else if (i == containers.size() || other.containers[j].key < containers[i].key)
+        {
+            merged.push_back(other.containers[j++]);
+        } else
+        {
+            containers[i].Or(other.containers[j++]);
+            merged.push_back(std::move(containers[i++]));
+        }
+    }
+    containers.swap(merged);
+}
+
+bool RoaringBitmap::Container::Contains(const uint16_t low) const
+{
+    if (isBitmap())
+    {
+        return (bitmap[low >> 6] >> (low & 63)) & 1;
+    }
+    return binary_search(array.begin(), array.end(), low);
+}
+
+void RoaringBitmap::Container::ToBitmap()
+{
+    bitmap.assign(ROARING_BITMAP_WORDS, 0);
+    for (const uint16_t low : array)
+    {
+        bitmap[low >> 6] |= static_cast<uint64_t>(1) << (low & 63);
+    }
+    array.clear();
+    array.shrink_to_fit();
+}
+
+void RoaringBitmap::Container::ToArray()
+{
+    array.clear();
+    array.reserve(cardinality);
+    for (size_t w = 0; w < ROARING_BITMAP_WORDS; ++w)
+    {
+        uint64_t word = bitmap[w];
+        while (word != 0)
+        {
+            array.push_back(static_cast<uint16_t>(w * 64 + __builtin_ctzll(word)));
+            word &= word - 1;
+        }
+    }
+    bitmap.clear();
+    bitmap.shrink_to_fit();
+}
+
+void RoaringBitmap::Container::And(const Container& other)
+{
+    if (isBitmap() && other.isBitmap())
+    {
+        cardinality = 0;
+        for (size_t w = 0; w < ROARING_BITMAP_WORDS; ++w)
+        {
+            bitmap[w] &= other.bitmap[w];
+            cardinality += static_cast<uint32_t>(__builtin_popcountll(bitmap[w]));
+        }
+
+        if (cardinality <= ROARING_BITMAP_ARRAY_MAX_SIZE)
+        {
+            ToArray();
+        }
+    } else if (isBitmap())
+    {
+        /*
+        * The result is no larger than the array, so it's an array.
+        */
+        vector<uint16_t> result;
+        result.reserve(other.array.size());
+        for (const uint16_t low : other.array)
+        {
+            if (Contains(low))
+            {
+                result.push_back(low);
+            }
+        }
+        bitmap.clear();
+        bitmap.shrink_to_fit();
+        array.swap(result);
+        cardinality = static_cast<uint32_t>(array.size());
+    } else if (other.isBitmap())
+    {
+        size_t kept = 0;
+        for (size_t i = 0; i < array.size(); ++i)
+        {
+            if (other.Contains(array[i]))
+            {
+                array[kept++] = array[i];
+            }
+        }
+        array.resize(kept);
+        cardinality = static_cast<uint32_t>(kept);
+    } else
+    {
+        vector<uint16_t> result(min(array.size(), other.array.size()));
+        result.resize(IntersectSorted(array.data(), array.size(), other.array.data(), other.array.size(), result.data()));
+        array.swap(result);
+        cardinality = static_cast<uint32_t>(array.size());
+    }
+}
+
+void RoaringBitmap::Container::Or(const Container& other)
+{
+    if (!isBitmap() && !other.isBitmap() && array.size() + other.array.size() <= ROARING_BITMAP_ARRAY_MAX_SIZE)
+    {
+        vector<uint16_t> result(array.size() + other.array.size());
+        result.resize(UnionSorted(array.data(), array.size(), other.array.data(), other.array.size(), result.data()));
+        array.swap(result);
+        cardinality = static_cast<uint32_t>(array.size());
+        return;
+    }
+
+    if (!isBitmap())
+    {
+        ToBitmap();
+    }
+
+    if (other.isBitmap())
+    {
+        for (size_t w = 0; w < ROARING_BITMAP_WORDS; ++w)
+        {
+            bitmap[w] |= other.bitmap[w];
+        }
+    } else
+    {
+        for (const uint16_t low : other.array)
+        {
+            bitmap[low >> 6] |= static_cast<uint64_t>(1) << (low & 63);
+        }
+    }
+
+    cardinality = 0;
+    for (size_t w = 0; w < ROARING_BITMAP_WORDS; ++w)
+    {
+        cardinality += static_cast<uint32_t>(__builtin_popcountll(bitmap[w]));
+    }
+
+    if (cardinality <= ROARING_BITMAP_ARRAY_MAX_SIZE)
+    {
+        ToArray();
+    }
+}
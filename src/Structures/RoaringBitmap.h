@@ -0,0 +1,100 @@
+#pragma once
+
+#include <cstdint>
+#include <cstddef>
+#include <vector>
+
+#define ROARING_BITMAP_ARRAY_MAX_SIZE (static_cast<size_t>(4096))  // a container with more values than this is stored as a bitmap (8KB), which is smaller than the array would be
+
+using namespace std;
+
+/*
+* A compressed set of 32 bit ids (eg. paragraph ids), in the style of Roaring bitmaps.
+*
+* Ids are split by their high 16 bits into containers. A container holds the low 16 bits of its ids either as a sorted array (when it has
+* few ids), or as a 65536 bit bitmap (when it has many), so that sparse and dense sets are both compact, and And() and Or() are
+* merges of sorted arrays or word-by-word bitwise operations rather than lookups per id.
+*/
+class RoaringBitmap
+{
+public:
+    RoaringBitmap() {}
+
+    /*
+    * ids must be strictly increasing.
+    */
+    RoaringBitmap(const uint32_t* ids, const size_t size);
+
+    bool Contains(const uint32_t id) const;
+
+    size_t Cardinality() const;
+
+    bool empty() const { return containers.empty(); }
+
+    /*
+    * this = this & other
+    */
+    void And(const RoaringBitmap& other);
+
+    /*
+    * this = this | other
+    */
+    void Or(const RoaringBitmap& other);
+
+    /*
+    * Calls f(id) for each id, in increasing order.
+    */
+    template<class F>
+    void ForEach(F f) const;
+
+    size_t MemoryUsage() const;
+
+protected:
+    struct Container
+    {
+        uint16_t key;               // the high 16 bits of the container's ids
+        uint32_t cardinality;
+        vector<uint16_t> array;     // sorted low 16 bits, if bitmap is empty
+        vector<uint64_t> bitmap;    // 1024 words, or empty if the container is an array
+
+        bool isBitmap() const { return !bitmap.empty(); }
+
+        bool Contains(const uint16_t low) const;
+
+        void ToBitmap();
+        void ToArray();
+
+        void And(const Container& other);
+        void Or(const Container& other);
+    };
+
+    vector<Container> containers;   // ordered by key, never empty
+};
+
+template<class F>
+void RoaringBitmap::ForEach(F f) const
+{
+    for (const Container& container : containers)
+    {
+        const uint32_t high = static_cast<uint32_t>(container.key) << 16;
+
+        if (container.isBitmap())
+        {
+            for (size_t w = 0; w < container.bitmap.size(); ++w)
+            {
+                uint64_t word = container.bitmap[w];
+                while (word != 0)
+                {
+                    f(high | static_cast<uint32_t>(w * 64 + __builtin_ctzll(word)));
+                    word &= word - 1;
+                }
+            }
+        } else
+        {
+            for (const uint16_t low : container.array)
+            {
+                f(high | low);
+            }
+        }
+    }
+}
@@ -0,0 +1,307 @@
+#include <algorithm>
+
+#include "SortedSetKernels.h"
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+/*
+* The AVX2 kernel is compiled for AVX2 regardless of the compiler flags (with a target attribute), and only called if the CPU has AVX2.
+*/
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#include <immintrin.h>
+#define SORTED_SET_RUNTIME_DISPATCH
+#endif
+
+typedef size_t (*IntersectKernel)(const uint32_t* a, const size_t a_size, const uint32_t* b, const size_t b_size, uint32_t* out);
+
+/*
+* A merge with no branch on the comparison of the two ids, only on reaching the end of a set.
+*/
+template<class T>
+static size_t IntersectScalar(const T* a, const size_t a_size, const T* b, const size_t b_size, T* out)
+{
+    size_t i = 0;
+    size_t j = 0;
+    size_t n = 0;
+
+    while (i < a_size && j < b_size)
+    {
+        const T x = a[i];
+        const T y = b[j];
+
+        out[n] = x;
+        n += (x == y);
+        i += (x <= y);
+        j += (y <= x);
+    }
+    return n;
+}
+
+/*
+* For each id of small, an exponential search of large, starting where the previous id was found.
+*/
+template<class T>
+static size_t IntersectGalloping(const T* small, const size_t small_size, const T* large, const size_t large_size, T* out)
+{
+    size_t n = 0;
+    size_t low = 0;   // every id of large before low is < the current id of small
+
+    for (size_t i = 0; i < small_size && low < large_size; ++i)
+    {
+        const T x = small[i];
+
+        size_t bound = 1;
+        while (low + bound < large_size && large[low + bound] < x)
+        {
+            bound <<= 1;
+        }
+
+        const T* found = lower_bound(large + low + bound / 2, large + min(low + bound + 1, large_size), x);
+        low = static_cast<size_t>(found - large);
+
+        if (low < large_size && *found == x)
+        {
+            out[n++] = x;
+            ++low;
+        }
+    }
+    return n;
+}
+
+#if defined(__SSE2__)
+/*
+* Compares 4 ids of a with 4 ids of b (all 16 pairs) by comparing a with each rotation of b, then moves past whichever block ends first (or both).
+* The ids of a that matched are picked out of the comparison's bitmask.
+*/
+static size_t IntersectSSE2(const uint32_t* a, const size_t a_size, const uint32_t* b, const size_t b_size, uint32_t* out)
+{
+    size_t i = 0;
+    size_t j = 0;
+    size_t n = 0;
+
+    while (i + 4 <= a_size && j + 4 <= b_size)
+    {
+        const __m128i va = _mm_loadu_si128(reinterpret_cast<const __m128i*>(a + i));
+        const __m128i vb = _mm_loadu_si128(reinterpret_cast<const __m128i*>(b + j));
+
+        __m128i equal = _mm_cmpeq_epi32(va, vb);
+        equal = _mm_or_si128(equal, _mm_cmpeq_epi32(va, _mm_shuffle_epi32(vb, _MM_SHUFFLE(0, 3, 2, 1))));
+        equal = _mm_or_si128(equal, _mm_cmpeq_epi32(va, _mm_shuffle_epi32(vb, _MM_SHUFFLE(1, 0, 3, 2))));
+        equal = _mm_or_si128(equal, _mm_cmpeq_epi32(va, _mm_shuffle_epi32(vb, _MM_SHUFFLE(2, 1, 0, 3))));
+
+        uint32_t mask = static_cast<uint32_t>(_mm_movemask_ps(_mm_castsi128_ps(equal)));
+        while (mask != 0)
+        {
+            out[n++] = a[i + __builtin_ctz(mask)];
+            mask &= mask - 1;
+        }
+
+        const uint32_t a_last = a[i + 3];
+        const uint32_t b_last = b[j + 3];
+        i += (a_last <= b_last) ? 4 : 0;
+        j += (b_last <= a_last) ? 4 : 0;
+    }
+
+    return n + IntersectScalar(a + i, a_size - i, b + j, b_size - j, out + n);
+}
+
+/*
+* As above, with 8 ids of a against 8 ids of b. A 16 bit lane is rotated with two byte shifts, since SSE2 has no 16 bit shuffle across the register.
+*/
+static size_t IntersectSSE2(const uint16_t* a, const size_t a_size, const uint16_t* b, const size_t b_size, uint16_t* out)
+{
+    size_t i = 0;
+    size_t j = 0;
+    size_t n = 0;
+
+    while (i + 8 <= a_size && j + 8 <= b_size)
+    {
+        const __m128i va = _mm_loadu_si128(reinterpret_cast<const __m128i*>(a + i));
+        __m128i vb = _mm_loadu_si128(reinterpret_cast<const __m128i*>(b + j));
+
+        __m128i equal = _mm_cmpeq_epi16(va, vb);
+        for (int r = 1; r < 8; ++r)
+        {
+            vb = _mm_or_si128(_mm_srli_si128(vb, 2), _mm_slli_si128(vb, 14));
+            equal = _mm_or_si128(equal, _mm_cmpeq_epi16(va, vb));
+        }
+
+        /*
+        * 2 bits per id, so each match clears both of its bits.
+        */
+        uint32_t mask = static_cast<uint32_t>(_mm_movemask_epi8(equal));
+        while (mask != 0)
+        {
+            const int bit = __builtin_ctz(mask);
+            out[n++] = a[i + bit / 2];
+            mask &= ~(3u << bit);
+        }
+
+        const uint16_t a_last = a[i + 7];
+        const uint16_t b_last = b[j + 7];
+        i += (a_last <= b_last) ? 8 : 0;
+        j += (b_last <= a_last) ? 8 : 0;
+    }
+
+    return n + IntersectScalar(a + i, a_size - i, b + j, b_size - j, out + n);
+}
+#endif
+
+#ifdef SORTED_SET_RUNTIME_DISPATCH
+/*
+* As IntersectSSE2(), with 8 ids of a against 8 ids of b.
+*/
+__attribute__((target("avx2")))
+static size_t IntersectAVX2(const uint32_t* a, const size_t a_size, const uint32_t* b, const size_t b_size, uint32_t* out)
+{
+    size_t i = 0;
+    size_t j = 0;
+    size_t n = 0;
+
+    const __m256i rotate = _mm256_setr_epi32(1, 2, 3, 4, 5, 6, 7, 0);
+
+    while (i + 8 <= a_size && j + 8 <= b_size)
+    {
+        const __m256i va = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(a + i));
+        __m256i vb = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(b + j));
+
+        __m256i equal = _mm256_cmpeq_epi32(va, vb);
+        for (int r = 1; r < 8; ++r)
+        {
+            vb = _mm256_permutevar8x32_epi32(vb, rotate);
+            equal = _mm256_or_si256(equal, _mm256_cmpeq_epi32(va, vb));
+        }
+
+        uint32_t mask = static_cast<uint32_t>(_mm256_movemask_ps(_mm256_castsi256_ps(equal)));
+        while (mask != 0)
+        {
+            out[n++] = a[i + __builtin_ctz(mask)];
+            mask &= mask - 1;
+        }
+
+        const uint32_t a_last = a[i + 7];
+        const uint32_t b_last = b[j + 7];
+        i += (a_last <= b_last) ? 8 : 0;
+        j += (b_last <= a_last) ? 8 : 0;
+    }
+
+    return n + IntersectScalar(a + i, a_size - i, b + j, b_size - j, out + n);
+}
+#endif
+
+struct IntersectVariant
+{
+    IntersectKernel kernel;
+    const char* name;
+};
+
+static IntersectVariant SelectIntersectVariant()
+{
+#ifdef SORTED_SET_RUNTIME_DISPATCH
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx2"))
+    {
+        return {IntersectAVX2, "avx2"};
+    }
+#endif
+#if defined(__SSE2__)
+    return {IntersectSSE2, "sse2"};
+#else
+    return {IntersectScalar<uint32_t>, "scalar"};
+#endif
+}
+
+/*
+* Selected on first use, so CPU detection never runs before static initialization.
+*/
+static const IntersectVariant& SelectedIntersectVariant()
+{
+    static const IntersectVariant variant = SelectIntersectVariant();
+    return variant;
+}
+
+size_t IntersectSorted(const uint32_t* a, const size_t a_size, const uint32_t* b, const size_t b_size, uint32_t* out)
+{
+    if (a_size == 0 || b_size == 0)
+    {
+        return 0;
+    }
+
+    if (a_size / b_size >= SORTED_SET_GALLOP_RATIO)
+    {
+        return IntersectGalloping(b, b_size, a, a_size, out);
+    }
+
+    if (b_size / a_size >= SORTED_SET_GALLOP_RATIO)
+    {
+        return IntersectGalloping(a, a_size, b, b_size, out);
+    }
+
+    return SelectedIntersectVariant().kernel(a, a_size, b, b_size, out);
+}
+
+size_t IntersectSorted(const uint16_t* a, const size_t a_size, const uint16_t* b, const size_t b_size, uint16_t* out)
+{
+    if (a_size == 0 || b_size == 0)
+    {
+        return 0;
+    }
+
+    if (a_size / b_size >= SORTED_SET_GALLOP_RATIO)
+    {
+        return IntersectGalloping(b, b_size, a, a_size, out);
+    }
+
+    if (b_size / a_size >= SORTED_SET_GALLOP_RATIO)
+    {
+        return IntersectGalloping(a, a_size, b, b_size, out);
+    }
+
+#if defined(__SSE2__)
+    return IntersectSSE2(a, a_size, b, b_size, out);
+#else
+    return IntersectScalar(a, a_size, b, b_size, out);
+#endif
+}
+
+/*
+* A merge that takes the smaller head of the two sets (a conditional move, rather than a branch), and both if they're equal.
+*/
+template<class T>
+static size_t UnionScalar(const T* a, const size_t a_size, const T* b, const size_t b_size, T* out)
+{
+    size_t i = 0;
+    size_t j = 0;
+    size_t n = 0;
+
+    while (i < a_size && j < b_size)
+    {
+        const T x = a[i];
+        const T y = b[j];
+
+        out[n++] = min(x, y);
+        i += (x <= y);
+        j += (y <= x);
+    }
+
+    out = copy(a + i, a + a_size, out + n);
+    copy(b + j, b + b_size, out);
+    return n + (a_size - i) + (b_size - j);
+}
+
+size_t UnionSorted(const uint32_t* a, const size_t a_size, const uint32_t* b, const size_t b_size, uint32_t* out)
+{
+    return UnionScalar(a, a_size, b, b_size, out);
+}
+
+size_t UnionSorted(const uint16_t* a, const size_t a_size, const uint16_t* b, const size_t b_size, uint16_t* out)
+{
+    return UnionScalar(a, a_size, b, b_size, out);
+}
+
+const char* IntersectSortedVariant()
+{
+    return SelectedIntersectVariant().name;
+}
@@ -0,0 +1,38 @@
+#pragma once
+
+#include <cstdint>
+#include <cstddef>
+
+#define SORTED_SET_GALLOP_RATIO 32  // intersections of sets whose sizes differ by more than this factor gallop through the larger set instead of merging
+
+using namespace std;
+
+/*
+* Intersection and union of sorted sets of ids (eg. paragraph ids, or the low 16 bits of them in a RoaringBitmap container).
+* Every input must be strictly increasing, and every output is.
+*
+* Intersections of similarly sized sets compare a block of one set against a block of the other in a few SIMD instructions (4x4 or 8x8 ids),
+* so that there is one branch per block instead of one hard to predict branch per id. Intersections of very differently sized sets gallop
+* (exponential search) through the larger set for each id of the smaller one, which is O(small * log(large)) instead of O(small + large).
+*
+* The SIMD variant for 32 bit ids is chosen once, at runtime, from what the CPU supports (AVX2, SSE2, or scalar), so a binary built for a baseline CPU
+* still uses AVX2 where it's available. 32 bit ids are intersected to find the candidate paragraphs of a phrase (see Search::findPhraseParagraphs()),
+* and 16 bit ids by RoaringBitmap's array containers.
+*/
+
+/*
+* Writes a & b to out, which must have room for min(a_size, b_size) ids and must not overlap a or b. Returns the number of ids written.
+*/
+size_t IntersectSorted(const uint16_t* a, const size_t a_size, const uint16_t* b, const size_t b_size, uint16_t* out);
+size_t IntersectSorted(const uint32_t* a, const size_t a_size, const uint32_t* b, const size_t b_size, uint32_t* out);
+
+/*
+* Writes a | b to out, which must have room for a_size + b_size ids and must not overlap a or b. Returns the number of ids written.
+*/
+size_t UnionSorted(const uint16_t* a, const size_t a_size, const uint16_t* b, const size_t b_size, uint16_t* out);
+size_t UnionSorted(const uint32_t* a, const size_t a_size, const uint32_t* b, const size_t b_size, uint32_t* out);
+
+/*
+* The variant that IntersectSorted() uses for similarly sized sets of 32 bit ids: "avx2", "sse2" or "scalar". Sets of 16 bit ids use SSE2 where it exists.
+*/
+const char* IntersectSortedVariant();
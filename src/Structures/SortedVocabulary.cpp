@@ -0,0 +1,87 @@
+#include <algorithm>
+
+#include "SortedVocabulary.h"
+
+SortedVocabulary::SortedVocabulary(const vector<pair<string, int64_t>>& in_words) : words(in_words)
+{
+    sort(words.begin(), words.end());
+
+    for (const auto& word : words)
+    {
+        max_word_size = max(max_word_size, word.first.size());
+    }
+}
+
+size_t SortedVocabulary::MemoryUsage() const
+{
+    size_t bytes = words.capacity() * sizeof(pair<string, int64_t>);
+    for (const auto& word : words)
+    {
+        bytes += (word.first.capacity() > 15) ? word.first.capacity() + 1 : 0;     // short words are stored inside the string
+    }
+    return bytes;
+}
+
+void SortedVocabulary::FindAccepted(const LevenshteinAutomaton& automaton, vector<pair<size_t, uint8_t>>& accepted) const
+{
+    accepted.clear();
+    if (words.empty())
+    {
+        return;
+    }
+
+    /*
+    * states[d * state_size] is the state after reading the first d bytes of path, which is the prefix that the walk is at.
+    */
+    const size_t state_size = automaton.StateSize();
+    vector<uint8_t> states((max_word_size + 1) * state_size);
+    automaton.Start(states.data());
+
+    string path;
+    path.reserve(max_word_size);
+
+    size_t i = 0;
+    while (i < words.size())
+    {
+        const string& word = words[i].first;
+
+        size_t depth = 0;
+        while (depth < path.size() && depth < word.size() && path[depth] == word[depth])
+        {
+            ++depth;
+        }
+        path.resize(depth);
+
+        bool dead_end = false;
+        for (; depth < word.size(); ++depth)
+        {
+            path.push_back(word[depth]);
+
+            if (!automaton.Step(&states[depth * state_size], word[depth], &states[(depth + 1) * state_size]))
+            {
+                dead_end = true;
+                break;
+            }
+        }
+
+        if (!dead_end)
+        {
+            if (automaton.Distance(&states[word.size() * state_size]) <= automaton.MaxDistance())
+            {
+                accepted.push_back({i, automaton.Distance(&states[word.size() * state_size])});
+            }
+            ++i;
+            continue;
+        }
+
+        /*
+        * path is a dead end, and every word that starts with it comes right after this one.
+        */
+        path.pop_back();
+        const string_view prefix(word.data(), depth + 1);
+
+        i = static_cast<size_t>(partition_point(words.begin() + i + 1, words.end(), [&](const pair<string, int64_t>& other) {
+            return string_view(other.first).substr(0, prefix.size()) <= prefix;
+        }) - words.begin());
+    }
+}
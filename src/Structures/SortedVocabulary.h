@@ -0,0 +1,50 @@
+#pragma once
+
+#include <cstdint>
+#include <cstddef>
+#include <string>
+#include <string_view>
+#include <vector>
+#include <utility>
+
+#include "LevenshteinAutomaton.h"
+
+using namespace std;
+
+/*
+* The vocabulary (the Words table) in sorted order, which is a trie without the pointers: the words that start with a prefix are consecutive,
+* and two consecutive words share the path of their common prefix.
+*/
+class SortedVocabulary
+{
+public:
+    SortedVocabulary() {}
+
+    /*
+    * words[i].first has the id words[i].second. The words must be distinct.
+    */
+    SortedVocabulary(const vector<pair<string, int64_t>>& in_words);
+
+    bool empty() const { return words.empty(); }
+
+    size_t size() const { return words.size(); }
+
+    const string& Word(const size_t i) const { return words[i].first; }
+
+    int64_t Id(const size_t i) const { return words[i].second; }
+
+    /*
+    * Replaces accepted with the index (for Word() and Id()) and distance of each word that the automaton accepts, in sorted order.
+    *
+    * The automaton is run down the implicit trie: each word only reads the bytes after the prefix it shares with the previous word,
+    * and once a prefix is a dead end, every word that starts with it is skipped with a binary search.
+    * So only the prefixes within MaxDistance() edits of a prefix of the automaton's word are visited, not every word.
+    */
+    void FindAccepted(const LevenshteinAutomaton& automaton, vector<pair<size_t, uint8_t>>& accepted) const;
+
+    size_t MemoryUsage() const;
+
+protected:
+    vector<pair<string, int64_t>> words;    // sorted by word
+    size_t max_word_size = 0;
+};
@@ -0,0 +1,97 @@
+#include <algorithm>
+#include <cstring>
+
+#include "TokenFilters.h"
+
+#ifdef TOKEN_FILTERS_REMOVE_POSSESSIVES
+/*
+* Strips leading apostrophes, then a trailing "'s" or trailing apostrophes.
+*/
+static size_t RemovePossessive(char* word, size_t size)
+{
+    size_t leading = 0;
+    while (leading < size && word[leading] == '\'')
+    {
+        ++leading;
+    }
+
+    if (leading > 0)
+    {
+        size -= leading;
+        memmove(word, word + leading, size);
+    }
+
+    if (size > 2 && word[size - 2] == '\'' && word[size - 1] == 's')
+    {
+        size -= 2;
+    }
+
+    while (size > 0 && word[size - 1] == '\'')
+    {
+        --size;
+    }
+    return size;
+}
+#endif
+
+#ifdef TOKEN_FILTERS_LIGHT_STEMMING
+/*
+* Harman's "S" stemmer: only plural endings are removed, so it rarely conflates unrelated words, and prefixes of the stem still match while the user types.
+*   "ies" -> "y", unless preceded by 'e' or 'a'
+*   "es"  -> "e", unless preceded by 'a', 'e' or 'o'
+*   "s"   -> "",  unless preceded by 'u' or 's'
+*/
+static size_t LightStem(char* word, const size_t size)
+{
+    if (size < 4 || word[size - 1] != 's')
+    {
+        return size;
+    }
+
+    if (word[size - 3] == 'i' && word[size - 2] == 'e' && word[size - 4] != 'e' && word[size - 4] != 'a')
+    {
+        word[size - 3] = 'y';
+        return size - 2;
+    }
+
+    if (word[size - 2] == 'e' && word[size - 3] != 'a' && word[size - 3] != 'e' && word[size - 3] != 'o')
+    {
+        return size - 1;
+    }
+
+    if (word[size - 2] != 'u' && word[size - 2] != 's')
+    {
+        return size - 1;
+    }
+    return size;
+}
+#endif
+
+/*
+* Sorted, so it can be binary searched.
+*/
+static constexpr string_view STOP_WORDS[] = {
+    "a", "an", "and", "are", "as", "at", "be", "but", "by", "for", "from", "has", "have", "he", "her", "his", "i", "in", "is", "it", "its", 
+    "of", "on", "or", "she", "that", "the", "their", "they", "this", "to", "was", "we", "were", "which", "will", "with", "you"
+};
+
+bool IsStopWord(const string_view word)
+{
+    return binary_search(begin(STOP_WORDS), end(STOP_WORDS), word);
+}
+
+size_t FilterToken(char* word, size_t size, bool& stop_word)
+{
+#ifdef TOKEN_FILTERS_REMOVE_POSSESSIVES
+    size = RemovePossessive(word, size);
+#endif
+#ifdef TOKEN_FILTERS_LIGHT_STEMMING
+    size = LightStem(word, size);
+#endif
+#ifdef TOKEN_FILTERS_MARK_STOP_WORDS
+    stop_word = size > 0 && IsStopWord(string_view(word, size));
+#else
+    stop_word = false;
+#endif
+    return size;
+}
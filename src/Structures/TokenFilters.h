@@ -0,0 +1,40 @@
+#pragma once
+
+#include <cstddef>
+#include <string_view>
+
+/*
+* The token filters that NormalizedText applies to every word, in this order. 
+* Paragraphs and queries are both normalized by NormalizedText, so ingest and search always agree on the filters. 
+* A database that was loaded with different filters must be reloaded.
+*/
+#define TOKEN_FILTERS_SPLIT_PUNCTUATION        // comment out this line to keep ASCII punctuation (other than '&', '-', '_' and ''') as part of words
+#define TOKEN_FILTERS_REMOVE_POSSESSIVES       // comment out this line to keep possessives and leading/trailing apostrophes (eg. "summit's" -> "summit", "'quoted'" -> "quoted")
+// #define TOKEN_FILTERS_LIGHT_STEMMING        // uncomment this line to strip English plural endings (eg. "springs" -> "spring", "berries" -> "berry")
+#define TOKEN_FILTERS_MARK_STOP_WORDS          // comment out this line to treat every word as a regular word
+
+using namespace std;
+
+/*
+* True if the (ASCII) character separates words, like a space does.
+*/
+inline bool IsWordSeparator(const char c)
+{
+#ifdef TOKEN_FILTERS_SPLIT_PUNCTUATION
+    const bool punctuation = (c >= '!' && c <= '/') || (c >= ':' && c <= '@') || (c >= '[' && c <= '`') || (c >= '{' && c <= '~');
+    return c == ' ' || (punctuation && c != '&' && c != '-' && c != '_' && c != '\'');
+#else
+    return c == ' ';
+#endif
+}
+
+/*
+* Runs the enabled filters over a normalized word, in place. Returns the word's new size, which is 0 if the word should be dropped (eg. it was only apostrophes).
+* stop_word is set if TOKEN_FILTERS_MARK_STOP_WORDS is defined and the (filtered) word is a stop word.
+*/
+size_t FilterToken(char* word, size_t size, bool& stop_word);
+
+/*
+* Common English words that occur in most paragraphs (eg. "the", "of", "and").
+*/
+bool IsStopWord(const string_view word);
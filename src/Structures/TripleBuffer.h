@@ -0,0 +1,69 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+
+using namespace std;
+
+/*
+* Lock-free hand-off of a value from one producer thread to one consumer thread.
+*
+* It works like a double buffer with a spare slot in the middle: the producer fills its back slot and swaps it with the middle slot,
+* and the consumer swaps its front slot with the middle slot when there is something new in it.
+* Neither side ever waits for the other, and the consumer always picks up the most recently published value.
+* Slots are reused, so a vector that is cleared and refilled by the producer keeps its capacity.
+*/
+template<class T>
+class TripleBuffer
+{
+public:
+    TripleBuffer() : middle{1}, back{0}, front{2} {}
+
+    TripleBuffer(const TripleBuffer&) = delete;
+    TripleBuffer& operator=(const TripleBuffer&) = delete;
+
+    /*
+    * Producer thread only.
+    * Returns the slot to fill in before calling Publish(). It contains whatever was published two or more calls ago.
+    */
+    T& WriteBuffer() { return slots[back]; }
+
+    /*
+    * Producer thread only.
+    */
+    void Publish()
+    {
+        const uint8_t previous_middle = middle.exchange(back | FRESH, memory_order_acq_rel);
+        back = previous_middle & INDEX;
+    }
+
+    /*
+    * Consumer thread only.
+    * Picks up the most recently published value, if there is one. Returns true if the front slot changed.
+    */
+    bool Update()
+    {
+        if ((middle.load(memory_order_relaxed) & FRESH) == 0)
+        {
+            return false;
+        }
+
+        const uint8_t previous_middle = middle.exchange(front, memory_order_acq_rel);
+        front = previous_middle & INDEX;
+        return true;
+    }
+
+    /*
+    * Consumer thread only.
+    */
+    const T& Read() const { return slots[front]; }
+
+protected:
+    static constexpr uint8_t INDEX = 0x3;
+    static constexpr uint8_t FRESH = 0x4;
+
+    array<T, 3> slots;
+    atomic<uint8_t> middle; // index of the middle slot, plus the FRESH bit when the producer has published since the consumer's last Update()
+    uint8_t back;           // owned by the producer
+    uint8_t front;          // owned by the consumer
+};
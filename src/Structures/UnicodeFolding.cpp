@@ -0,0 +1,1422 @@
+#include <algorithm>
+
+#include "UnicodeFolding.h"
+
+size_t DecodeUtf8(const char* in, const size_t size, uint32_t& code_point)
+{
+    const uint8_t* s = reinterpret_cast<const uint8_t*>(in);
+    size_t length;
+    uint32_t minimum;
+
+    if (s[0] < 0x80)
+    {
+        code_point = s[0];
+        return 1;
+    } else if ((s[0] & 0xE0) == 0xC0)
+    {
+        length = 2;
+        minimum = 0x80;
+        code_point = s[0] & 0x1F;
+    } else if ((s[0] & 0xF0) == 0xE0)
+    {
+        length = 3;
+        minimum = 0x800;
+        code_point = s[0] & 0x0F;
+    } else if ((s[0] & 0xF8) == 0xF0)
+    {
+        length = 4;
+        minimum = 0x10000;
+        code_point = s[0] & 0x07;
+    } else
+    {
+        return 0;
+    }
+
+    if (length > size)
+    {
+        return 0;
+    }
+
+    for (size_t i = 1; i < length; ++i)
+    {
+        if ((s[i] & 0xC0) != 0x80)
+        {
+            return 0;
+        }
+        code_point = (code_point << 6) | (s[i] & 0x3F);
+    }
+
+    if (code_point < minimum || code_point > 0x10FFFF || (code_point >= 0xD800 && code_point <= 0xDFFF))
+    {
+        return 0;
+    }
+    return length;
+}
+
+struct FoldedCodePoint
+{
+    uint32_t code_point;
+    uint8_t size;
+    char folded[UNICODE_FOLDING_MAX_SIZE + 1];
+};
+
+/*
+* Sorted by code point. Only code points that change are listed.
+* 
+* Generated from the Unicode 14.0 character database: each character was decomposed (NFKD), stripped of its combining marks, 
+* lowercased and recomposed (NFC). Results that are still not ASCII are only kept for single letters (eg. Greek and Cyrillic lowercase).
+* Letters that don't decompose but are conventionally written without their stroke or ligature were added by hand (eg. "ø" -> "o", "æ" -> "ae", "ł" -> "l").
+* 
+* Covers Latin-1, Latin Extended-A/B and Additional, combining diacritics, Greek, Cyrillic, general punctuation, letterlike symbols, 
+* number forms, the ideographic space, Latin ligatures, variation selectors, and fullwidth ASCII.
+*/
+static constexpr FoldedCodePoint FOLDED_CODE_POINTS[] = {
+    {0x00A0, 1, " "},
+    {0x00A8, 1, " "},
+    {0x00AA, 1, "a"},
+    {0x00AB, 1, "\x22"},
+    {0x00AD, 0, ""},
+    {0x00AF, 1, " "},
+    {0x00B2, 1, "2"},
+    {0x00B3, 1, "3"},
+    {0x00B4, 1, " "},
+    {0x00B5, 2, "\xce\xbc"},
+    {0x00B8, 1, " "},
+    {0x00B9, 1, "1"},
+    {0x00BA, 1, "o"},
+    {0x00BB, 1, "\x22"},
+    {0x00BC, 3, "1/4"},
+    {0x00BD, 3, "1/2"},
+    {0x00BE, 3, "3/4"},
+    {0x00C0, 1, "a"},
+    {0x00C1, 1, "a"},
+    {0x00C2, 1, "a"},
+    {0x00C3, 1, "a"},
+    {0x00C4, 1, "a"},
+    {0x00C5, 1, "a"},
+    {0x00C6, 2, "ae"},
+    {0x00C7, 1, "c"},
+    {0x00C8, 1, "e"},
+    {0x00C9, 1, "e"},
+    {0x00CA, 1, "e"},
+    {0x00CB, 1, "e"},
+    {0x00CC, 1, "i"},
+    {0x00CD, 1, "i"},
+    {0x00CE, 1, "i"},
+    {0x00CF, 1, "i"},
+    {0x00D0, 1, "d"},
+    {0x00D1, 1, "n"},
+    {0x00D2, 1, "o"},
+    {0x00D3, 1, "o"},
+    {0x00D4, 1, "o"},
+    {0x00D5, 1, "o"},
+    {0x00D6, 1, "o"},
+    {0x00D8, 1, "o"},
+    {0x00D9, 1, "u"},
+    {0x00DA, 1, "u"},
+    {0x00DB, 1, "u"},
+    {0x00DC, 1, "u"},
+    {0x00DD, 1, "y"},
+    {0x00DE, 2, "th"},
+    {0x00DF, 2, "ss"},
+    {0x00E0, 1, "a"},
+    {0x00E1, 1, "a"},
+    {0x00E2, 1, "a"},
+    {0x00E3, 1, "a"},
+    {0x00E4, 1, "a"},
+    {0x00E5, 1, "a"},
+    {0x00E6, 2, "ae"},
+    {0x00E7, 1, "c"},
+    {0x00E8, 1, "e"},
+    {0x00E9, 1, "e"},
+    {0x00EA, 1, "e"},
+    {0x00EB, 1, "e"},
+    {0x00EC, 1, "i"},
+    {0x00ED, 1, "i"},
+    {0x00EE, 1, "i"},
+    {0x00EF, 1, "i"},
+    {0x00F0, 1, "d"},
+    {0x00F1, 1, "n"},
+    {0x00F2, 1, "o"},
+    {0x00F3, 1, "o"},
+    {0x00F4, 1, "o"},
+    {0x00F5, 1, "o"},
+    {0x00F6, 1, "o"},
+    {0x00F8, 1, "o"},
+    {0x00F9, 1, "u"},
+    {0x00FA, 1, "u"},
+    {0x00FB, 1, "u"},
+    {0x00FC, 1, "u"},
+    {0x00FD, 1, "y"},
+    {0x00FE, 2, "th"},
+    {0x00FF, 1, "y"},
+    {0x0100, 1, "a"},
+    {0x0101, 1, "a"},
+    {0x0102, 1, "a"},
+    {0x0103, 1, "a"},
+    {0x0104, 1, "a"},
+    {0x0105, 1, "a"},
+    {0x0106, 1, "c"},
+    {0x0107, 1, "c"},
+    {0x0108, 1, "c"},
+    {0x0109, 1, "c"},
+    {0x010A, 1, "c"},
+    {0x010B, 1, "c"},
+    {0x010C, 1, "c"},
+    {0x010D, 1, "c"},
+    {0x010E, 1, "d"},
+    {0x010F, 1, "d"},
+    {0x0110, 1, "d"},
+    {0x0111, 1, "d"},
+    {0x0112, 1, "e"},
+    {0x0113, 1, "e"},
+    {0x0114, 1, "e"},
+    {0x0115, 1, "e"},
+    {0x0116, 1, "e"},
+    {0x0117, 1, "e"},
+    {0x0118, 1, "e"},
+    {0x0119, 1, "e"},
+    {0x011A, 1, "e"},
+    {0x011B, 1, "e"},
+    {0x011C, 1, "g"},
+    {0x011D, 1, "g"},
+    {0x011E, 1, "g"},
+    {0x011F, 1, "g"},
+    {0x0120, 1, "g"},
+    {0x0121, 1, "g"},
+    {0x0122, 1, "g"},
+    {0x0123, 1, "g"},
+    {0x0124, 1, "h"},
+    {0x0125, 1, "h"},
+    {0x0126, 1, "h"},
+    {0x0127, 1, "h"},
+    {0x0128, 1, "i"},
+    {0x0129, 1, "i"},
+    {0x012A, 1, "i"},
+    {0x012B, 1, "i"},
+    {0x012C, 1, "i"},
+    {0x012D, 1, "i"},
+    {0x012E, 1, "i"},
+    {0x012F, 1, "i"},
+    {0x0130, 1, "i"},
+    {0x0131, 1, "i"},
+    {0x0132, 2, "ij"},
+    {0x0133, 2, "ij"},
+    {0x0134, 1, "j"},
+    {0x0135, 1, "j"},
+    {0x0136, 1, "k"},
+    {0x0137, 1, "k"},
+    {0x0139, 1, "l"},
+    {0x013A, 1, "l"},
+    {0x013B, 1, "l"},
+    {0x013C, 1, "l"},
+    {0x013D, 1, "l"},
+    {0x013E, 1, "l"},
+    {0x0141, 1, "l"},
+    {0x0142, 1, "l"},
+    {0x0143, 1, "n"},
+    {0x0144, 1, "n"},
+    {0x0145, 1, "n"},
+    {0x0146, 1, "n"},
+    {0x0147, 1, "n"},
+    {0x0148, 1, "n"},
+    {0x014A, 2, "\xc5\x8b"},
+    {0x014C, 1, "o"},
+    {0x014D, 1, "o"},
+    {0x014E, 1, "o"},
+    {0x014F, 1, "o"},
+    {0x0150, 1, "o"},
+    {0x0151, 1, "o"},
+    {0x0152, 2, "oe"},
+    {0x0153, 2, "oe"},
+    {0x0154, 1, "r"},
+    {0x0155, 1, "r"},
+    {0x0156, 1, "r"},
+    {0x0157, 1, "r"},
+    {0x0158, 1, "r"},
+    {0x0159, 1, "r"},
+    {0x015A, 1, "s"},
+    {0x015B, 1, "s"},
+    {0x015C, 1, "s"},
+    {0x015D, 1, "s"},
+    {0x015E, 1, "s"},
+    {0x015F, 1, "s"},
+    {0x0160, 1, "s"},
+    {0x0161, 1, "s"},
+    {0x0162, 1, "t"},
+    {0x0163, 1, "t"},
+    {0x0164, 1, "t"},
+    {0x0165, 1, "t"},
+    {0x0166, 1, "t"},
+    {0x0167, 1, "t"},
+    {0x0168, 1, "u"},
+    {0x0169, 1, "u"},
+    {0x016A, 1, "u"},
+    {0x016B, 1, "u"},
+    {0x016C, 1, "u"},
+    {0x016D, 1, "u"},
+    {0x016E, 1, "u"},
+    {0x016F, 1, "u"},
+    {0x0170, 1, "u"},
+    {0x0171, 1, "u"},
+    {0x0172, 1, "u"},
+    {0x0173, 1, "u"},
+    {0x0174, 1, "w"},
+    {0x0175, 1, "w"},
+    {0x0176, 1, "y"},
+    {0x0177, 1, "y"},
+    {0x0178, 1, "y"},
+    {0x0179, 1, "z"},
+    {0x017A, 1, "z"},
+    {0x017B, 1, "z"},
+    {0x017C, 1, "z"},
+    {0x017D, 1, "z"},
+    {0x017E, 1, "z"},
+    {0x017F, 1, "s"},
+    {0x0181, 2, "\xc9\x93"},
+    {0x0182, 2, "\xc6\x83"},
+    {0x0184, 2, "\xc6\x85"},
+    {0x0186, 2, "\xc9\x94"},
+    {0x0187, 2, "\xc6\x88"},
+    {0x0189, 2, "\xc9\x96"},
+    {0x018A, 2, "\xc9\x97"},
+    {0x018B, 2, "\xc6\x8c"},
+    {0x018E, 2, "\xc7\x9d"},
+    {0x018F, 1, "e"},
+    {0x0190, 2, "\xc9\x9b"},
+    {0x0191, 2, "\xc6\x92"},
+    {0x0193, 2, "\xc9\xa0"},
+    {0x0194, 2, "\xc9\xa3"},
+    {0x0196, 2, "\xc9\xa9"},
+    {0x0197, 2, "\xc9\xa8"},
+    {0x0198, 2, "\xc6\x99"},
+    {0x019C, 2, "\xc9\xaf"},
+    {0x019D, 2, "\xc9\xb2"},
+    {0x019F, 2, "\xc9\xb5"},
+    {0x01A0, 1, "o"},
+    {0x01A1, 1, "o"},
+    {0x01A2, 2, "\xc6\xa3"},
+    {0x01A4, 2, "\xc6\xa5"},
+    {0x01A6, 2, "\xca\x80"},
+    {0x01A7, 2, "\xc6\xa8"},
+    {0x01A9, 2, "\xca\x83"},
+    {0x01AC, 2, "\xc6\xad"},
+    {0x01AE, 2, "\xca\x88"},
+    {0x01AF, 1, "u"},
+    {0x01B0, 1, "u"},
+    {0x01B1, 2, "\xca\x8a"},
+    {0x01B2, 2, "\xca\x8b"},
+    {0x01B3, 2, "\xc6\xb4"},
+    {0x01B5, 2, "\xc6\xb6"},
+    {0x01B7, 2, "\xca\x92"},
+    {0x01B8, 2, "\xc6\xb9"},
+    {0x01BC, 2, "\xc6\xbd"},
+    {0x01C4, 2, "dz"},
+    {0x01C5, 2, "dz"},
+    {0x01C6, 2, "dz"},
+    {0x01C7, 2, "lj"},
+    {0x01C8, 2, "lj"},
+    {0x01C9, 2, "lj"},
+    {0x01CA, 2, "nj"},
+    {0x01CB, 2, "nj"},
+    {0x01CC, 2, "nj"},
+    {0x01CD, 1, "a"},
+    {0x01CE, 1, "a"},
+    {0x01CF, 1, "i"},
+    {0x01D0, 1, "i"},
+    {0x01D1, 1, "o"},
+    {0x01D2, 1, "o"},
+    {0x01D3, 1, "u"},
+    {0x01D4, 1, "u"},
+    {0x01D5, 1, "u"},
+    {0x01D6, 1, "u"},
+    {0x01D7, 1, "u"},
+    {0x01D8, 1, "u"},
+    {0x01D9, 1, "u"},
+    {0x01DA, 1, "u"},
+    {0x01DB, 1, "u"},
+    {0x01DC, 1, "u"},
+    {0x01DE, 1, "a"},
+    {0x01DF, 1, "a"},
+    {0x01E0, 1, "a"},
+    {0x01E1, 1, "a"},
+    {0x01E2, 2, "ae"},
+    {0x01E3, 2, "ae"},
+    {0x01E4, 2, "\xc7\xa5"},
+    {0x01E6, 1, "g"},
+    {0x01E7, 1, "g"},
+    {0x01E8, 1, "k"},
+    {0x01E9, 1, "k"},
+    {0x01EA, 1, "o"},
+    {0x01EB, 1, "o"},
+    {0x01EC, 1, "o"},
+    {0x01ED, 1, "o"},
+    {0x01EE, 2, "\xca\x92"},
+    {0x01EF, 2, "\xca\x92"},
+    {0x01F0, 1, "j"},
+    {0x01F1, 2, "dz"},
+    {0x01F2, 2, "dz"},
+    {0x01F3, 2, "dz"},
+    {0x01F4, 1, "g"},
+    {0x01F5, 1, "g"},
+    {0x01F6, 2, "\xc6\x95"},
+    {0x01F7, 2, "\xc6\xbf"},
+    {0x01F8, 1, "n"},
+    {0x01F9, 1, "n"},
+    {0x01FA, 1, "a"},
+    {0x01FB, 1, "a"},
+    {0x01FC, 2, "ae"},
+    {0x01FD, 2, "ae"},
+    {0x01FE, 1, "o"},
+    {0x01FF, 1, "o"},
+    {0x0200, 1, "a"},
+    {0x0201, 1, "a"},
+    {0x0202, 1, "a"},
+    {0x0203, 1, "a"},
+    {0x0204, 1, "e"},
+    {0x0205, 1, "e"},
+    {0x0206, 1, "e"},
+    {0x0207, 1, "e"},
+    {0x0208, 1, "i"},
+    {0x0209, 1, "i"},
+    {0x020A, 1, "i"},
+    {0x020B, 1, "i"},
+    {0x020C, 1, "o"},
+    {0x020D, 1, "o"},
+    {0x020E, 1, "o"},
+    {0x020F, 1, "o"},
+    {0x0210, 1, "r"},
+    {0x0211, 1, "r"},
+    {0x0212, 1, "r"},
+    {0x0213, 1, "r"},
+    {0x0214, 1, "u"},
+    {0x0215, 1, "u"},
+    {0x0216, 1, "u"},
+    {0x0217, 1, "u"},
+    {0x0218, 1, "s"},
+    {0x0219, 1, "s"},
+    {0x021A, 1, "t"},
+    {0x021B, 1, "t"},
+    {0x021C, 2, "\xc8\x9d"},
+    {0x021E, 1, "h"},
+    {0x021F, 1, "h"},
+    {0x0220, 2, "\xc6\x9e"},
+    {0x0222, 2, "\xc8\xa3"},
+    {0x0224, 2, "\xc8\xa5"},
+    {0x0226, 1, "a"},
+    {0x0227, 1, "a"},
+    {0x0228, 1, "e"},
+    {0x0229, 1, "e"},
+    {0x022A, 1, "o"},
+    {0x022B, 1, "o"},
+    {0x022C, 1, "o"},
+    {0x022D, 1, "o"},
+    {0x022E, 1, "o"},
+    {0x022F, 1, "o"},
+    {0x0230, 1, "o"},
+    {0x0231, 1, "o"},
+    {0x0232, 1, "y"},
+    {0x0233, 1, "y"},
+    {0x023A, 3, "\xe2\xb1\xa5"},
+    {0x023B, 2, "\xc8\xbc"},
+    {0x023D, 2, "\xc6\x9a"},
+    {0x023E, 3, "\xe2\xb1\xa6"},
+    {0x0241, 2, "\xc9\x82"},
+    {0x0243, 2, "\xc6\x80"},
+    {0x0244, 2, "\xca\x89"},
+    {0x0245, 2, "\xca\x8c"},
+    {0x0246, 2, "\xc9\x87"},
+    {0x0248, 2, "\xc9\x89"},
+    {0x024A, 2, "\xc9\x8b"},
+    {0x024C, 2, "\xc9\x8d"},
+    {0x024E, 2, "\xc9\x8f"},
+    {0x0259, 1, "e"},
+    {0x0300, 0, ""},
+    {0x0301, 0, ""},
+    {0x0302, 0, ""},
+    {0x0303, 0, ""},
+    {0x0304, 0, ""},
+    {0x0305, 0, ""},
+    {0x0306, 0, ""},
+    {0x0307, 0, ""},
+    {0x0308, 0, ""},
+    {0x0309, 0, ""},
+    {0x030A, 0, ""},
+    {0x030B, 0, ""},
+    {0x030C, 0, ""},
+    {0x030D, 0, ""},
+    {0x030E, 0, ""},
+    {0x030F, 0, ""},
+    {0x0310, 0, ""},
+    {0x0311, 0, ""},
+    {0x0312, 0, ""},
+    {0x0313, 0, ""},
+    {0x0314, 0, ""},
+    {0x0315, 0, ""},
+    {0x0316, 0, ""},
+    {0x0317, 0, ""},
+    {0x0318, 0, ""},
+    {0x0319, 0, ""},
+    {0x031A, 0, ""},
+    {0x031B, 0, ""},
+    {0x031C, 0, ""},
+    {0x031D, 0, ""},
+    {0x031E, 0, ""},
+    {0x031F, 0, ""},
+    {0x0320, 0, ""},
+    {0x0321, 0, ""},
+    {0x0322, 0, ""},
+    {0x0323, 0, ""},
+    {0x0324, 0, ""},
+    {0x0325, 0, ""},
+    {0x0326, 0, ""},
+    {0x0327, 0, ""},
+    {0x0328, 0, ""},
+    {0x0329, 0, ""},
+    {0x032A, 0, ""},
+    {0x032B, 0, ""},
+    {0x032C, 0, ""},
+    {0x032D, 0, ""},
+    {0x032E, 0, ""},
+    {0x032F, 0, ""},
+    {0x0330, 0, ""},
+    {0x0331, 0, ""},
+    {0x0332, 0, ""},
+    {0x0333, 0, ""},
+    {0x0334, 0, ""},
+    {0x0335, 0, ""},
+    {0x0336, 0, ""},
+    {0x0337, 0, ""},
+    {0x0338, 0, ""},
+    {0x0339, 0, ""},
+    {0x033A, 0, ""},
+    {0x033B, 0, ""},
+    {0x033C, 0, ""},
+    {0x033D, 0, ""},
+    {0x033E, 0, ""},
+    {0x033F, 0, ""},
+    {0x0340, 0, ""},
+    {0x0341, 0, ""},
+    {0x0342, 0, ""},
+    {0x0343, 0, ""},
+    {0x0344, 0, ""},
+    {0x0345, 0, ""},
+    {0x0346, 0, ""},
+    {0x0347, 0, ""},
+    {0x0348, 0, ""},
+    {0x0349, 0, ""},
+    {0x034A, 0, ""},
+    {0x034B, 0, ""},
+    {0x034C, 0, ""},
+    {0x034D, 0, ""},
+    {0x034E, 0, ""},
+    {0x034F, 0, ""},
+    {0x0350, 0, ""},
+    {0x0351, 0, ""},
+    {0x0352, 0, ""},
+    {0x0353, 0, ""},
+    {0x0354, 0, ""},
+    {0x0355, 0, ""},
+    {0x0356, 0, ""},
+    {0x0357, 0, ""},
+    {0x0358, 0, ""},
+    {0x0359, 0, ""},
+    {0x035A, 0, ""},
+    {0x035B, 0, ""},
+    {0x035C, 0, ""},
+    {0x035D, 0, ""},
+    {0x035E, 0, ""},
+    {0x035F, 0, ""},
+    {0x0360, 0, ""},
+    {0x0361, 0, ""},
+    {0x0362, 0, ""},
+    {0x0363, 0, ""},
+    {0x0364, 0, ""},
+    {0x0365, 0, ""},
+    {0x0366, 0, ""},
+    {0x0367, 0, ""},
+    {0x0368, 0, ""},
+    {0x0369, 0, ""},
+    {0x036A, 0, ""},
+    {0x036B, 0, ""},
+    {0x036C, 0, ""},
+    {0x036D, 0, ""},
+    {0x036E, 0, ""},
+    {0x036F, 0, ""},
+    {0x0370, 2, "\xcd\xb1"},
+    {0x0372, 2, "\xcd\xb3"},
+    {0x0374, 2, "\xca\xb9"},
+    {0x0376, 2, "\xcd\xb7"},
+    {0x037A, 1, " "},
+    {0x037E, 1, ";"},
+    {0x037F, 2, "\xcf\xb3"},
+    {0x0384, 1, " "},
+    {0x0385, 1, " "},
+    {0x0386, 2, "\xce\xb1"},
+    {0x0388, 2, "\xce\xb5"},
+    {0x0389, 2, "\xce\xb7"},
+    {0x038A, 2, "\xce\xb9"},
+    {0x038C, 2, "\xce\xbf"},
+    {0x038E, 2, "\xcf\x85"},
+    {0x038F, 2, "\xcf\x89"},
+    {0x0390, 2, "\xce\xb9"},
+    {0x0391, 2, "\xce\xb1"},
+    {0x0392, 2, "\xce\xb2"},
+    {0x0393, 2, "\xce\xb3"},
+    {0x0394, 2, "\xce\xb4"},
+    {0x0395, 2, "\xce\xb5"},
+    {0x0396, 2, "\xce\xb6"},
+    {0x0397, 2, "\xce\xb7"},
+    {0x0398, 2, "\xce\xb8"},
+    {0x0399, 2, "\xce\xb9"},
+    {0x039A, 2, "\xce\xba"},
+    {0x039B, 2, "\xce\xbb"},
+    {0x039C, 2, "\xce\xbc"},
+    {0x039D, 2, "\xce\xbd"},
+    {0x039E, 2, "\xce\xbe"},
+    {0x039F, 2, "\xce\xbf"},
+    {0x03A0, 2, "\xcf\x80"},
+    {0x03A1, 2, "\xcf\x81"},
+    {0x03A3, 2, "\xcf\x83"},
+    {0x03A4, 2, "\xcf\x84"},
+    {0x03A5, 2, "\xcf\x85"},
+    {0x03A6, 2, "\xcf\x86"},
+    {0x03A7, 2, "\xcf\x87"},
+    {0x03A8, 2, "\xcf\x88"},
+    {0x03A9, 2, "\xcf\x89"},
+    {0x03AA, 2, "\xce\xb9"},
+    {0x03AB, 2, "\xcf\x85"},
+    {0x03AC, 2, "\xce\xb1"},
+    {0x03AD, 2, "\xce\xb5"},
+    {0x03AE, 2, "\xce\xb7"},
+    {0x03AF, 2, "\xce\xb9"},
+    {0x03B0, 2, "\xcf\x85"},
+    {0x03CA, 2, "\xce\xb9"},
+    {0x03CB, 2, "\xcf\x85"},
+    {0x03CC, 2, "\xce\xbf"},
+    {0x03CD, 2, "\xcf\x85"},
+    {0x03CE, 2, "\xcf\x89"},
+    {0x03CF, 2, "\xcf\x97"},
+    {0x03D0, 2, "\xce\xb2"},
+    {0x03D1, 2, "\xce\xb8"},
+    {0x03D2, 2, "\xcf\x85"},
+    {0x03D3, 2, "\xcf\x85"},
+    {0x03D4, 2, "\xcf\x85"},
+    {0x03D5, 2, "\xcf\x86"},
+    {0x03D6, 2, "\xcf\x80"},
+    {0x03D8, 2, "\xcf\x99"},
+    {0x03DA, 2, "\xcf\x9b"},
+    {0x03DC, 2, "\xcf\x9d"},
+    {0x03DE, 2, "\xcf\x9f"},
+    {0x03E0, 2, "\xcf\xa1"},
+    {0x03E2, 2, "\xcf\xa3"},
+    {0x03E4, 2, "\xcf\xa5"},
+    {0x03E6, 2, "\xcf\xa7"},
+    {0x03E8, 2, "\xcf\xa9"},
+    {0x03EA, 2, "\xcf\xab"},
+    {0x03EC, 2, "\xcf\xad"},
+    {0x03EE, 2, "\xcf\xaf"},
+    {0x03F0, 2, "\xce\xba"},
+    {0x03F1, 2, "\xcf\x81"},
+    {0x03F2, 2, "\xcf\x82"},
+    {0x03F4, 2, "\xce\xb8"},
+    {0x03F5, 2, "\xce\xb5"},
+    {0x03F7, 2, "\xcf\xb8"},
+    {0x03F9, 2, "\xcf\x83"},
+    {0x03FA, 2, "\xcf\xbb"},
+    {0x03FD, 2, "\xcd\xbb"},
+    {0x03FE, 2, "\xcd\xbc"},
+    {0x03FF, 2, "\xcd\xbd"},
+    {0x0400, 2, "\xd0\xb5"},
+    {0x0401, 2, "\xd0\xb5"},
+    {0x0402, 2, "\xd1\x92"},
+    {0x0403, 2, "\xd0\xb3"},
+    {0x0404, 2, "\xd1\x94"},
+    {0x0405, 2, "\xd1\x95"},
+    {0x0406, 2, "\xd1\x96"},
+    {0x0407, 2, "\xd1\x96"},
+    {0x0408, 2, "\xd1\x98"},
+    {0x0409, 2, "\xd1\x99"},
+    {0x040A, 2, "\xd1\x9a"},
+    {0x040B, 2, "\xd1\x9b"},
+    {0x040C, 2, "\xd0\xba"},
+    {0x040D, 2, "\xd0\xb8"},
+    {0x040E, 2, "\xd1\x83"},
+    {0x040F, 2, "\xd1\x9f"},
+    {0x0410, 2, "\xd0\xb0"},
+    {0x0411, 2, "\xd0\xb1"},
+    {0x0412, 2, "\xd0\xb2"},
+    {0x0413, 2, "\xd0\xb3"},
+    {0x0414, 2, "\xd0\xb4"},
+    {0x0415, 2, "\xd0\xb5"},
+    {0x0416, 2, "\xd0\xb6"},
+    {0x0417, 2, "\xd0\xb7"},
+    {0x0418, 2, "\xd0\xb8"},
+    {0x0419, 2, "\xd0\xb8"},
+    {0x041A, 2, "\xd0\xba"},
+    {0x041B, 2, "\xd0\xbb"},
+    {0x041C, 2, "\xd0\xbc"},
+    {0x041D, 2, "\xd0\xbd"},
+    {0x041E, 2, "\xd0\xbe"},
+    {0x041F, 2, "\xd0\xbf"},
+    {0x0420, 2, "\xd1\x80"},
+    {0x0421, 2, "\xd1\x81"},
+    {0x0422, 2, "\xd1\x82"},
+    {0x0423, 2, "\xd1\x83"},
+    {0x0424, 2, "\xd1\x84"},
+    {0x0425, 2, "\xd1\x85"},
+    {0x0426, 2, "\xd1\x86"},
+    {0x0427, 2, "\xd1\x87"},
+    {0x0428, 2, "\xd1\x88"},
+    {0x0429, 2, "\xd1\x89"},
+    {0x042A, 2, "\xd1\x8a"},
+    {0x042B, 2, "\xd1\x8b"},
+    {0x042C, 2, "\xd1\x8c"},
+    {0x042D, 2, "\xd1\x8d"},
+    {0x042E, 2, "\xd1\x8e"},
+    {0x042F, 2, "\xd1\x8f"},
+    {0x0439, 2, "\xd0\xb8"},
+    {0x0450, 2, "\xd0\xb5"},
+    {0x0451, 2, "\xd0\xb5"},
+    {0x0453, 2, "\xd0\xb3"},
+    {0x0457, 2, "\xd1\x96"},
+    {0x045C, 2, "\xd0\xba"},
+    {0x045D, 2, "\xd0\xb8"},
+    {0x045E, 2, "\xd1\x83"},
+    {0x0460, 2, "\xd1\xa1"},
+    {0x0462, 2, "\xd1\xa3"},
+    {0x0464, 2, "\xd1\xa5"},
+    {0x0466, 2, "\xd1\xa7"},
+    {0x0468, 2, "\xd1\xa9"},
+    {0x046A, 2, "\xd1\xab"},
+    {0x046C, 2, "\xd1\xad"},
+    {0x046E, 2, "\xd1\xaf"},
+    {0x0470, 2, "\xd1\xb1"},
+    {0x0472, 2, "\xd1\xb3"},
+    {0x0474, 2, "\xd1\xb5"},
+    {0x0476, 2, "\xd1\xb5"},
+    {0x0477, 2, "\xd1\xb5"},
+    {0x0478, 2, "\xd1\xb9"},
+    {0x047A, 2, "\xd1\xbb"},
+    {0x047C, 2, "\xd1\xbd"},
+    {0x047E, 2, "\xd1\xbf"},
+    {0x0480, 2, "\xd2\x81"},
+    {0x0483, 0, ""},
+    {0x0484, 0, ""},
+    {0x0485, 0, ""},
+    {0x0486, 0, ""},
+    {0x0487, 0, ""},
+    {0x048A, 2, "\xd2\x8b"},
+    {0x048C, 2, "\xd2\x8d"},
+    {0x048E, 2, "\xd2\x8f"},
+    {0x0490, 2, "\xd2\x91"},
+    {0x0492, 2, "\xd2\x93"},
+    {0x0494, 2, "\xd2\x95"},
+    {0x0496, 2, "\xd2\x97"},
+    {0x0498, 2, "\xd2\x99"},
+    {0x049A, 2, "\xd2\x9b"},
+    {0x049C, 2, "\xd2\x9d"},
+    {0x049E, 2, "\xd2\x9f"},
+    {0x04A0, 2, "\xd2\xa1"},
+    {0x04A2, 2, "\xd2\xa3"},
+    {0x04A4, 2, "\xd2\xa5"},
+    {0x04A6, 2, "\xd2\xa7"},
+    {0x04A8, 2, "\xd2\xa9"},
+    {0x04AA, 2, "\xd2\xab"},
+    {0x04AC, 2, "\xd2\xad"},
+    {0x04AE, 2, "\xd2\xaf"},
+    {0x04B0, 2, "\xd2\xb1"},
+    {0x04B2, 2, "\xd2\xb3"},
+    {0x04B4, 2, "\xd2\xb5"},
+    {0x04B6, 2, "\xd2\xb7"},
+    {0x04B8, 2, "\xd2\xb9"},
+    {0x04BA, 2, "\xd2\xbb"},
+    {0x04BC, 2, "\xd2\xbd"},
+    {0x04BE, 2, "\xd2\xbf"},
+    {0x04C0, 2, "\xd3\x8f"},
+    {0x04C1, 2, "\xd0\xb6"},
+    {0x04C2, 2, "\xd0\xb6"},
+    {0x04C3, 2, "\xd3\x84"},
+    {0x04C5, 2, "\xd3\x86"},
+    {0x04C7, 2, "\xd3\x88"},
+    {0x04C9, 2, "\xd3\x8a"},
+    {0x04CB, 2, "\xd3\x8c"},
+    {0x04CD, 2, "\xd3\x8e"},
+    {0x04D0, 2, "\xd0\xb0"},
+    {0x04D1, 2, "\xd0\xb0"},
+    {0x04D2, 2, "\xd0\xb0"},
+    {0x04D3, 2, "\xd0\xb0"},
+    {0x04D4, 2, "\xd3\x95"},
+    {0x04D6, 2, "\xd0\xb5"},
+    {0x04D7, 2, "\xd0\xb5"},
+    {0x04D8, 2, "\xd3\x99"},
+    {0x04DA, 2, "\xd3\x99"},
+    {0x04DB, 2, "\xd3\x99"},
+    {0x04DC, 2, "\xd0\xb6"},
+    {0x04DD, 2, "\xd0\xb6"},
+    {0x04DE, 2, "\xd0\xb7"},
+    {0x04DF, 2, "\xd0\xb7"},
+    {0x04E0, 2, "\xd3\xa1"},
+    {0x04E2, 2, "\xd0\xb8"},
+    {0x04E3, 2, "\xd0\xb8"},
+    {0x04E4, 2, "\xd0\xb8"},
+    {0x04E5, 2, "\xd0\xb8"},
+    {0x04E6, 2, "\xd0\xbe"},
+    {0x04E7, 2, "\xd0\xbe"},
+    {0x04E8, 2, "\xd3\xa9"},
+    {0x04EA, 2, "\xd3\xa9"},
+    {0x04EB, 2, "\xd3\xa9"},
+    {0x04EC, 2, "\xd1\x8d"},
+    {0x04ED, 2, "\xd1\x8d"},
+    {0x04EE, 2, "\xd1\x83"},
+    {0x04EF, 2, "\xd1\x83"},
+    {0x04F0, 2, "\xd1\x83"},
+    {0x04F1, 2, "\xd1\x83"},
+    {0x04F2, 2, "\xd1\x83"},
+    {0x04F3, 2, "\xd1\x83"},
+    {0x04F4, 2, "\xd1\x87"},
+    {0x04F5, 2, "\xd1\x87"},
+    {0x04F6, 2, "\xd3\xb7"},
+    {0x04F8, 2, "\xd1\x8b"},
+    {0x04F9, 2, "\xd1\x8b"},
+    {0x04FA, 2, "\xd3\xbb"},
+    {0x04FC, 2, "\xd3\xbd"},
+    {0x04FE, 2, "\xd3\xbf"},
+    {0x0500, 2, "\xd4\x81"},
+    {0x0502, 2, "\xd4\x83"},
+    {0x0504, 2, "\xd4\x85"},
+    {0x0506, 2, "\xd4\x87"},
+    {0x0508, 2, "\xd4\x89"},
+    {0x050A, 2, "\xd4\x8b"},
+    {0x050C, 2, "\xd4\x8d"},
+    {0x050E, 2, "\xd4\x8f"},
+    {0x0510, 2, "\xd4\x91"},
+    {0x0512, 2, "\xd4\x93"},
+    {0x0514, 2, "\xd4\x95"},
+    {0x0516, 2, "\xd4\x97"},
+    {0x0518, 2, "\xd4\x99"},
+    {0x051A, 2, "\xd4\x9b"},
+    {0x051C, 2, "\xd4\x9d"},
+    {0x051E, 2, "\xd4\x9f"},
+    {0x0520, 2, "\xd4\xa1"},
+    {0x0522, 2, "\xd4\xa3"},
+    {0x0524, 2, "\xd4\xa5"},
+    {0x0526, 2, "\xd4\xa7"},
+    {0x0528, 2, "\xd4\xa9"},
+    {0x052A, 2, "\xd4\xab"},
+    {0x052C, 2, "\xd4\xad"},
+    {0x052E, 2, "\xd4\xaf"},
+    {0x1E00, 1, "a"},
+    {0x1E01, 1, "a"},
+    {0x1E02, 1, "b"},
+    {0x1E03, 1, "b"},
+    {0x1E04, 1, "b"},
+    {0x1E05, 1, "b"},
+    {0x1E06, 1, "b"},
+    {0x1E07, 1, "b"},
+    {0x1E08, 1, "c"},
+    {0x1E09, 1, "c"},
+    {0x1E0A, 1, "d"},
+    {0x1E0B, 1, "d"},
+    {0x1E0C, 1, "d"},
+    {0x1E0D, 1, "d"},
+    {0x1E0E, 1, "d"},
+    {0x1E0F, 1, "d"},
+    {0x1E10, 1, "d"},
+    {0x1E11, 1, "d"},
+    {0x1E12, 1, "d"},
+    {0x1E13, 1, "d"},
+    {0x1E14, 1, "e"},
+    {0x1E15, 1, "e"},
+    {0x1E16, 1, "e"},
+    {0x1E17, 1, "e"},
+    {0x1E18, 1, "e"},
+    {0x1E19, 1, "e"},
+    {0x1E1A, 1, "e"},
+    {0x1E1B, 1, "e"},
+    {0x1E1C, 1, "e"},
+    {0x1E1D, 1, "e"},
+    {0x1E1E, 1, "f"},
+    {0x1E1F, 1, "f"},
+    {0x1E20, 1, "g"},
+    {0x1E21, 1, "g"},
+    {0x1E22, 1, "h"},
+    {0x1E23, 1, "h"},
+    {0x1E24, 1, "h"},
+    {0x1E25, 1, "h"},
+    {0x1E26, 1, "h"},
+    {0x1E27, 1, "h"},
+    {0x1E28, 1, "h"},
+    {0x1E29, 1, "h"},
+    {0x1E2A, 1, "h"},
+    {0x1E2B, 1, "h"},
+    {0x1E2C, 1, "i"},
+    {0x1E2D, 1, "i"},
+    {0x1E2E, 1, "i"},
+    {0x1E2F, 1, "i"},
+    {0x1E30, 1, "k"},
+    {0x1E31, 1, "k"},
+    {0x1E32, 1, "k"},
+    {0x1E33, 1, "k"},
+    {0x1E34, 1, "k"},
+    {0x1E35, 1, "k"},
+    {0x1E36, 1, "l"},
+    {0x1E37, 1, "l"},
+    {0x1E38, 1, "l"},
+    {0x1E39, 1, "l"},
+    {0x1E3A, 1, "l"},
+    {0x1E3B, 1, "l"},
+    {0x1E3C, 1, "l"},
+    {0x1E3D, 1, "l"},
+    {0x1E3E, 1, "m"},
+    {0x1E3F, 1, "m"},
+    {0x1E40, 1, "m"},
+    {0x1E41, 1, "m"},
+    {0x1E42, 1, "m"},
+    {0x1E43, 1, "m"},
+    {0x1E44, 1, "n"},
+    {0x1E45, 1, "n"},
+    {0x1E46, 1, "n"},
+    {0x1E47, 1, "n"},
+    {0x1E48, 1, "n"},
+    {0x1E49, 1, "n"},
+    {0x1E4A, 1, "n"},
+    {0x1E4B, 1, "n"},
+    {0x1E4C, 1, "o"},
+    {0x1E4D, 1, "o"},
+    {0x1E4E, 1, "o"},
+    {0x1E4F, 1, "o"},
+    {0x1E50, 1, "o"},
+    {0x1E51, 1, "o"},
+    {0x1E52, 1, "o"},
+    {0x1E53, 1, "o"},
+    {0x1E54, 1, "p"},
+    {0x1E55, 1, "p"},
+    {0x1E56, 1, "p"},
+    {0x1E57, 1, "p"},
+    {0x1E58, 1, "r"},
+    {0x1E59, 1, "r"},
+    {0x1E5A, 1, "r"},
+    {0x1E5B, 1, "r"},
+    {0x1E5C, 1, "r"},
+    {0x1E5D, 1, "r"},
+    {0x1E5E, 1, "r"},
+    {0x1E5F, 1, "r"},
+    {0x1E60, 1, "s"},
+    {0x1E61, 1, "s"},
+    {0x1E62, 1, "s"},
+    {0x1E63, 1, "s"},
+    {0x1E64, 1, "s"},
+    {0x1E65, 1, "s"},
+    {0x1E66, 1, "s"},
+    {0x1E67, 1, "s"},
+    {0x1E68, 1, "s"},
+    {0x1E69, 1, "s"},
+    {0x1E6A, 1, "t"},
+    {0x1E6B, 1, "t"},
+    {0x1E6C, 1, "t"},
+    {0x1E6D, 1, "t"},
+    {0x1E6E, 1, "t"},
+    {0x1E6F, 1, "t"},
+    {0x1E70, 1, "t"},
+    {0x1E71, 1, "t"},
+    {0x1E72, 1, "u"},
+    {0x1E73, 1, "u"},
+    {0x1E74, 1, "u"},
+    {0x1E75, 1, "u"},
+    {0x1E76, 1, "u"},
+    {0x1E77, 1, "u"},
+    {0x1E78, 1, "u"},
+    {0x1E79, 1, "u"},
+    {0x1E7A, 1, "u"},
+    {0x1E7B, 1, "u"},
+    {0x1E7C, 1, "v"},
+    {0x1E7D, 1, "v"},
+    {0x1E7E, 1, "v"},
+    {0x1E7F, 1, "v"},
+    {0x1E80, 1, "w"},
+    {0x1E81, 1, "w"},
+    {0x1E82, 1, "w"},
+    {0x1E83, 1, "w"},
+    {0x1E84, 1, "w"},
+    {0x1E85, 1, "w"},
+    {0x1E86, 1, "w"},
+    {0x1E87, 1, "w"},
+    {0x1E88, 1, "w"},
+    {0x1E89, 1, "w"},
+    {0x1E8A, 1, "x"},
+    {0x1E8B, 1, "x"},
+    {0x1E8C, 1, "x"},
+    {0x1E8D, 1, "x"},
+    {0x1E8E, 1, "y"},
+    {0x1E8F, 1, "y"},
+    {0x1E90, 1, "z"},
+    {0x1E91, 1, "z"},
+    {0x1E92, 1, "z"},
+    {0x1E93, 1, "z"},
+    {0x1E94, 1, "z"},
+    {0x1E95, 1, "z"},
+    {0x1E96, 1, "h"},
+    {0x1E97, 1, "t"},
+    {0x1E98, 1, "w"},
+    {0x1E99, 1, "y"},
+    {0x1E9B, 1, "s"},
+    {0x1E9E, 2, "ss"},
+    {0x1EA0, 1, "a"},
+    {0x1EA1, 1, "a"},
+    {0x1EA2, 1, "a"},
+    {0x1EA3, 1, "a"},
+    {0x1EA4, 1, "a"},
+    {0x1EA5, 1, "a"},
+    {0x1EA6, 1, "a"},
+    {0x1EA7, 1, "a"},
+    {0x1EA8, 1, "a"},
+    {0x1EA9, 1, "a"},
+    {0x1EAA, 1, "a"},
+    {0x1EAB, 1, "a"},
+    {0x1EAC, 1, "a"},
+    {0x1EAD, 1, "a"},
+    {0x1EAE, 1, "a"},
+    {0x1EAF, 1, "a"},
+    {0x1EB0, 1, "a"},
+    {0x1EB1, 1, "a"},
+    {0x1EB2, 1, "a"},
+    {0x1EB3, 1, "a"},
+    {0x1EB4, 1, "a"},
+    {0x1EB5, 1, "a"},
+    {0x1EB6, 1, "a"},
+    {0x1EB7, 1, "a"},
+    {0x1EB8, 1, "e"},
+    {0x1EB9, 1, "e"},
+    {0x1EBA, 1, "e"},
+    {0x1EBB, 1, "e"},
+    {0x1EBC, 1, "e"},
+    {0x1EBD, 1, "e"},
+    {0x1EBE, 1, "e"},
+    {0x1EBF, 1, "e"},
+    {0x1EC0, 1, "e"},
+    {0x1EC1, 1, "e"},
+    {0x1EC2, 1, "e"},
+    {0x1EC3, 1, "e"},
+    {0x1EC4, 1, "e"},
+    {0x1EC5, 1, "e"},
+    {0x1EC6, 1, "e"},
+    {0x1EC7, 1, "e"},
+    {0x1EC8, 1, "i"},
+    {0x1EC9, 1, "i"},
+    {0x1ECA, 1, "i"},
+    {0x1ECB, 1, "i"},
+    {0x1ECC, 1, "o"},
+    {0x1ECD, 1, "o"},
+    {0x1ECE, 1, "o"},
+    {0x1ECF, 1, "o"},
+    {0x1ED0, 1, "o"},
+    {0x1ED1, 1, "o"},
+    {0x1ED2, 1, "o"},
+    {0x1ED3, 1, "o"},
+    {0x1ED4, 1, "o"},
+    {0x1ED5, 1, "o"},
+    {0x1ED6, 1, "o"},
+    {0x1ED7, 1, "o"},
+    {0x1ED8, 1, "o"},
+    {0x1ED9, 1, "o"},
+    {0x1EDA, 1, "o"},
+    {0x1EDB, 1, "o"},
+    {0x1EDC, 1, "o"},
+    {0x1EDD, 1, "o"},
+    {0x1EDE, 1, "o"},
+    {0x1EDF, 1, "o"},
+    {0x1EE0, 1, "o"},
+    {0x1EE1, 1, "o"},
+    {0x1EE2, 1, "o"},
+    {0x1EE3, 1, "o"},
+    {0x1EE4, 1, "u"},
+    {0x1EE5, 1, "u"},
+    {0x1EE6, 1, "u"},
+    {0x1EE7, 1, "u"},
+    {0x1EE8, 1, "u"},
+    {0x1EE9, 1, "u"},
+    {0x1EEA, 1, "u"},
+    {0x1EEB, 1, "u"},
+    {0x1EEC, 1, "u"},
+    {0x1EED, 1, "u"},
+    {0x1EEE, 1, "u"},
+    {0x1EEF, 1, "u"},
+    {0x1EF0, 1, "u"},
+    {0x1EF1, 1, "u"},
+    {0x1EF2, 1, "y"},
+    {0x1EF3, 1, "y"},
+    {0x1EF4, 1, "y"},
+    {0x1EF5, 1, "y"},
+    {0x1EF6, 1, "y"},
+    {0x1EF7, 1, "y"},
+    {0x1EF8, 1, "y"},
+    {0x1EF9, 1, "y"},
+    {0x1EFA, 3, "\xe1\xbb\xbb"},
+    {0x1EFC, 3, "\xe1\xbb\xbd"},
+    {0x1EFE, 3, "\xe1\xbb\xbf"},
+    {0x2000, 1, " "},
+    {0x2001, 1, " "},
+    {0x2002, 1, " "},
+    {0x2003, 1, " "},
+    {0x2004, 1, " "},
+    {0x2005, 1, " "},
+    {0x2006, 1, " "},
+    {0x2007, 1, " "},
+    {0x2008, 1, " "},
+    {0x2009, 1, " "},
+    {0x200A, 1, " "},
+    {0x200B, 0, ""},
+    {0x200C, 0, ""},
+    {0x200D, 0, ""},
+    {0x200E, 0, ""},
+    {0x200F, 0, ""},
+    {0x2010, 1, "-"},
+    {0x2011, 1, "-"},
+    {0x2012, 1, "-"},
+    {0x2013, 1, "-"},
+    {0x2014, 1, "-"},
+    {0x2015, 1, "-"},
+    {0x2017, 1, " "},
+    {0x2018, 1, "'"},
+    {0x2019, 1, "'"},
+    {0x201A, 1, "'"},
+    {0x201B, 1, "'"},
+    {0x201C, 1, "\x22"},
+    {0x201D, 1, "\x22"},
+    {0x201E, 1, "\x22"},
+    {0x201F, 1, "\x22"},
+    {0x2024, 1, "."},
+    {0x2025, 2, ".."},
+    {0x2026, 3, "..."},
+    {0x2028, 1, " "},
+    {0x2029, 1, " "},
+    {0x202A, 0, ""},
+    {0x202B, 0, ""},
+    {0x202C, 0, ""},
+    {0x202D, 0, ""},
+    {0x202E, 0, ""},
+    {0x202F, 1, " "},
+    {0x2032, 1, "'"},
+    {0x2033, 1, "\x22"},
+    {0x2039, 1, "'"},
+    {0x203A, 1, "'"},
+    {0x203C, 2, "!!"},
+    {0x203E, 1, " "},
+    {0x2047, 2, "??"},
+    {0x2048, 2, "?!"},
+    {0x2049, 2, "!?"},
+    {0x205F, 1, " "},
+    {0x2060, 0, ""},
+    {0x2061, 0, ""},
+    {0x2062, 0, ""},
+    {0x2063, 0, ""},
+    {0x2064, 0, ""},
+    {0x2066, 0, ""},
+    {0x2067, 0, ""},
+    {0x2068, 0, ""},
+    {0x2069, 0, ""},
+    {0x206A, 0, ""},
+    {0x206B, 0, ""},
+    {0x206C, 0, ""},
+    {0x206D, 0, ""},
+    {0x206E, 0, ""},
+    {0x206F, 0, ""},
+    {0x2100, 3, "a/c"},
+    {0x2101, 3, "a/s"},
+    {0x2102, 1, "c"},
+    {0x2105, 3, "c/o"},
+    {0x2106, 3, "c/u"},
+    {0x2107, 2, "\xc9\x9b"},
+    {0x210A, 1, "g"},
+    {0x210B, 1, "h"},
+    {0x210C, 1, "h"},
+    {0x210D, 1, "h"},
+    {0x210E, 1, "h"},
+    {0x210F, 1, "h"},
+    {0x2110, 1, "i"},
+    {0x2111, 1, "i"},
+    {0x2112, 1, "l"},
+    {0x2113, 1, "l"},
+    {0x2115, 1, "n"},
+    {0x2116, 2, "no"},
+    {0x2119, 1, "p"},
+    {0x211A, 1, "q"},
+    {0x211B, 1, "r"},
+    {0x211C, 1, "r"},
+    {0x211D, 1, "r"},
+    {0x2120, 2, "sm"},
+    {0x2121, 3, "tel"},
+    {0x2122, 2, "tm"},
+    {0x2124, 1, "z"},
+    {0x2126, 2, "\xcf\x89"},
+    {0x2128, 1, "z"},
+    {0x212A, 1, "k"},
+    {0x212B, 1, "a"},
+    {0x212C, 1, "b"},
+    {0x212D, 1, "c"},
+    {0x212F, 1, "e"},
+    {0x2130, 1, "e"},
+    {0x2131, 1, "f"},
+    {0x2132, 3, "\xe2\x85\x8e"},
+    {0x2133, 1, "m"},
+    {0x2134, 1, "o"},
+    {0x2135, 2, "\xd7\x90"},
+    {0x2136, 2, "\xd7\x91"},
+    {0x2137, 2, "\xd7\x92"},
+    {0x2138, 2, "\xd7\x93"},
+    {0x2139, 1, "i"},
+    {0x213B, 3, "fax"},
+    {0x213C, 2, "\xcf\x80"},
+    {0x213D, 2, "\xce\xb3"},
+    {0x213E, 2, "\xce\xb3"},
+    {0x213F, 2, "\xcf\x80"},
+    {0x2145, 1, "d"},
+    {0x2146, 1, "d"},
+    {0x2147, 1, "e"},
+    {0x2148, 1, "i"},
+    {0x2149, 1, "j"},
+    {0x2150, 3, "1/7"},
+    {0x2151, 3, "1/9"},
+    {0x2152, 4, "1/10"},
+    {0x2153, 3, "1/3"},
+    {0x2154, 3, "2/3"},
+    {0x2155, 3, "1/5"},
+    {0x2156, 3, "2/5"},
+    {0x2157, 3, "3/5"},
+    {0x2158, 3, "4/5"},
+    {0x2159, 3, "1/6"},
+    {0x215A, 3, "5/6"},
+    {0x215B, 3, "1/8"},
+    {0x215C, 3, "3/8"},
+    {0x215D, 3, "5/8"},
+    {0x215E, 3, "7/8"},
+    {0x215F, 2, "1/"},
+    {0x2160, 1, "i"},
+    {0x2161, 2, "ii"},
+    {0x2162, 3, "iii"},
+    {0x2163, 2, "iv"},
+    {0x2164, 1, "v"},
+    {0x2165, 2, "vi"},
+    {0x2166, 3, "vii"},
+    {0x2167, 4, "viii"},
+    {0x2168, 2, "ix"},
+    {0x2169, 1, "x"},
+    {0x216A, 2, "xi"},
+    {0x216B, 3, "xii"},
+    {0x216C, 1, "l"},
+    {0x216D, 1, "c"},
+    {0x216E, 1, "d"},
+    {0x216F, 1, "m"},
+    {0x2170, 1, "i"},
+    {0x2171, 2, "ii"},
+    {0x2172, 3, "iii"},
+    {0x2173, 2, "iv"},
+    {0x2174, 1, "v"},
+    {0x2175, 2, "vi"},
+    {0x2176, 3, "vii"},
+    {0x2177, 4, "viii"},
+    {0x2178, 2, "ix"},
+    {0x2179, 1, "x"},
+    {0x217A, 2, "xi"},
+    {0x217B, 3, "xii"},
+    {0x217C, 1, "l"},
+    {0x217D, 1, "c"},
+    {0x217E, 1, "d"},
+    {0x217F, 1, "m"},
+    {0x2183, 3, "\xe2\x86\x84"},
+    {0x2189, 3, "0/3"},
+    {0x3000, 1, " "},
+    {0xFB00, 2, "ff"},
+    {0xFB01, 2, "fi"},
+    {0xFB02, 2, "fl"},
+    {0xFB03, 3, "ffi"},
+    {0xFB04, 3, "ffl"},
+    {0xFB05, 2, "st"},
+    {0xFB06, 2, "st"},
+    {0xFE00, 0, ""},
+    {0xFE01, 0, ""},
+    {0xFE02, 0, ""},
+    {0xFE03, 0, ""},
+    {0xFE04, 0, ""},
+    {0xFE05, 0, ""},
+    {0xFE06, 0, ""},
+    {0xFE07, 0, ""},
+    {0xFE08, 0, ""},
+    {0xFE09, 0, ""},
+    {0xFE0A, 0, ""},
+    {0xFE0B, 0, ""},
+    {0xFE0C, 0, ""},
+    {0xFE0D, 0, ""},
+    {0xFE0E, 0, ""},
+    {0xFE0F, 0, ""},
+    {0xFEFF, 0, ""},
+    {0xFF01, 1, "!"},
+    {0xFF02, 1, "\x22"},
+    {0xFF03, 1, "#"},
+    {0xFF04, 1, "$"},
+    {0xFF05, 1, "%"},
+    {0xFF06, 1, "&"},
+    {0xFF07, 1, "'"},
+    {0xFF08, 1, "("},
+    {0xFF09, 1, ")"},
+    {0xFF0A, 1, "*"},
+    {0xFF0B, 1, "+"},
+    {0xFF0C, 1, ","},
+    {0xFF0D, 1, "-"},
+    {0xFF0E, 1, "."},
+    {0xFF0F, 1, "/"},
+    {0xFF10, 1, "0"},
+    {0xFF11, 1, "1"},
+    {0xFF12, 1, "2"},
+    {0xFF13, 1, "3"},
+    {0xFF14, 1, "4"},
+    {0xFF15, 1, "5"},
+    {0xFF16, 1, "6"},
+    {0xFF17, 1, "7"},
+    {0xFF18, 1, "8"},
+    {0xFF19, 1, "9"},
+    {0xFF1A, 1, ":"},
+    {0xFF1B, 1, ";"},
+    {0xFF1C, 1, "<"},
+    {0xFF1D, 1, "="},
+    {0xFF1E, 1, ">"},
+    {0xFF1F, 1, "?"},
+    {0xFF20, 1, "@"},
+    {0xFF21, 1, "a"},
+    {0xFF22, 1, "b"},
+    {0xFF23, 1, "c"},
+    {0xFF24, 1, "d"},
+    {0xFF25, 1, "e"},
+    {0xFF26, 1, "f"},
+    {0xFF27, 1, "g"},
+    {0xFF28, 1, "h"},
+    {0xFF29, 1, "i"},
+    {0xFF2A, 1, "j"},
+    {0xFF2B, 1, "k"},
+    {0xFF2C, 1, "l"},
+    {0xFF2D, 1, "m"},
+    {0xFF2E, 1, "n"},
+    {0xFF2F, 1, "o"},
+    {0xFF30, 1, "p"},
+    {0xFF31, 1, "q"},
+    {0xFF32, 1, "r"},
+    {0xFF33, 1, "s"},
+    {0xFF34, 1, "t"},
+    {0xFF35, 1, "u"},
+    {0xFF36, 1, "v"},
+    {0xFF37, 1, "w"},
+    {0xFF38, 1, "x"},
+    {0xFF39, 1, "y"},
+    {0xFF3A, 1, "z"},
+    {0xFF3B, 1, "["},
+    {0xFF3C, 1, "\x5c"},
+    {0xFF3D, 1, "]"},
+    {0xFF3E, 1, "^"},
+    {0xFF3F, 1, "_"},
+    {0xFF40, 1, "`"},
+    {0xFF41, 1, "a"},
+    {0xFF42, 1, "b"},
+    {0xFF43, 1, "c"},
+    {0xFF44, 1, "d"},
+    {0xFF45, 1, "e"},
+    {0xFF46, 1, "f"},
+    {0xFF47, 1, "g"},
+    {0xFF48, 1, "h"},
+    {0xFF49, 1, "i"},
+    {0xFF4A, 1, "j"},
+    {0xFF4B, 1, "k"},
+    {0xFF4C, 1, "l"},
+    {0xFF4D, 1, "m"},
+    {0xFF4E, 1, "n"},
+    {0xFF4F, 1, "o"},
+    {0xFF50, 1, "p"},
+    {0xFF51, 1, "q"},
+    {0xFF52, 1, "r"},
+    {0xFF53, 1, "s"},
+    {0xFF54, 1, "t"},
+    {0xFF55, 1, "u"},
+    {0xFF56, 1, "v"},
+    {0xFF57, 1, "w"},
+    {0xFF58, 1, "x"},
+    {0xFF59, 1, "y"},
+    {0xFF5A, 1, "z"},
+    {0xFF5B, 1, "{"},
+    {0xFF5C, 1, "|"},
+    {0xFF5D, 1, "}"},
+    {0xFF5E, 1, "~"},
+};
+
+static constexpr size_t FOLDED_CODE_POINTS_COUNT = sizeof(FOLDED_CODE_POINTS) / sizeof(FoldedCodePoint);
+
+/*
+* True if the code point is in FOLDED_CODE_POINTS. A constexpr binary search, for the check below.
+*/
+static constexpr bool IsFolded(const uint32_t code_point)
+{
+    size_t first = 0;
+    size_t last = FOLDED_CODE_POINTS_COUNT;
+
+    while (first < last)
+    {
+        const size_t middle = first + (last - first) / 2;
+
+        if (FOLDED_CODE_POINTS[middle].code_point < code_point)
+        {
+            first = middle + 1;
+        } else
+        {
+            last = middle;
+        }
+    }
+    return first < FOLDED_CODE_POINTS_COUNT && FOLDED_CODE_POINTS[first].code_point == code_point;
+}
+
+/*
+* True if no folded form contains a code point that folds again (the folded forms are valid UTF-8, so they're decoded without checks).
+* Otherwise a word would be normalized differently depending on whether it was typed folded or not (eg. "ẞ" to "ß", but "ß" to "ss"), 
+* and the vocabulary would get two spellings of it that never match each other.
+*/
+static constexpr bool FoldingIsIdempotent()
+{
+    for (size_t i = 0; i < FOLDED_CODE_POINTS_COUNT; ++i)
+    {
+        const FoldedCodePoint& entry = FOLDED_CODE_POINTS[i];
+
+        for (size_t j = 0; j < entry.size;)
+        {
+            const uint8_t lead = static_cast<uint8_t>(entry.folded[j]);
+            const size_t length = (lead < 0x80) ? 1 : ((lead & 0xE0) == 0xC0) ? 2 : ((lead & 0xF0) == 0xE0) ? 3 : 4;
+
+            uint32_t code_point = (length == 1) ? lead : (length == 2) ? (lead & 0x1F) : (length == 3) ? (lead & 0x0F) : (lead & 0x07);
+            for (size_t k = 1; k < length; ++k)
+            {
+                code_point = (code_point << 6) | (static_cast<uint8_t>(entry.folded[j + k]) & 0x3F);
+            }
+
+            if ((code_point >= 'A' && code_point <= 'Z') || IsFolded(code_point))
+            {
+                return false;   // NormalizedText lowercases ASCII, so an uppercase ASCII letter would be folded again too
+            }
+            j += length;
+        }
+    }
+    return true;
+}
+
+static_assert(FoldingIsIdempotent(), "A folded form in FOLDED_CODE_POINTS contains a code point that folds again. Write its fully folded form instead.");
+
+bool FoldCodePoint(const uint32_t code_point, const char*& folded, size_t& folded_size)
+{
+    const FoldedCodePoint* end = FOLDED_CODE_POINTS + sizeof(FOLDED_CODE_POINTS) / sizeof(FoldedCodePoint);
+    const FoldedCodePoint* entry = lower_bound(FOLDED_CODE_POINTS, end, code_point, [](const FoldedCodePoint& e, const uint32_t cp) { return e.code_point < cp; });
+
+    if (entry == end || entry->code_point != code_point)
+    {
+        return false;
+    }
+
+    folded = entry->folded;
+    folded_size = entry->size;
+    return true;
+}
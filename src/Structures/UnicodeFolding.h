@@ -0,0 +1,26 @@
+#pragma once
+
+#include <cstdint>
+#include <cstddef>
+
+#define UNICODE_FOLDING_MAX_SIZE (static_cast<size_t>(4)) // the longest folded form, in bytes (eg. "viii" for U+2167)
+
+using namespace std;
+
+/*
+* Decodes the UTF-8 sequence at the start of in[0, size). 
+* Returns its length in bytes, or 0 if it isn't valid UTF-8 (a stray continuation byte, a truncated or overlong sequence, a surrogate, or > U+10FFFF).
+*/
+size_t DecodeUtf8(const char* in, const size_t size, uint32_t& code_point);
+
+/*
+* Looks up the folded form of a non-ASCII code point, which is what NormalizedText writes in its place:
+*   - letters are lowercased, and stripped of diacritics when they decompose to a base letter (NFKD), eg. "É" -> "e", "ß" -> "ss", "Ω" -> "ω"
+*   - compatibility characters are replaced by what they are compatible with (NFKC), eg. "ﬁ" -> "fi", "Ａ" -> "a", "½" -> "1/2"
+*   - combining marks and invisible format characters (eg. U+00AD soft hyphen, U+200B zero width space) fold to nothing
+*   - Unicode spaces fold to ' ', dashes to '-', and curly quotes to their ASCII counterparts, so they're handled like the ASCII characters are
+* 
+* Returns false if the code point is unchanged by folding, in which case its UTF-8 is copied as is.
+* The folded form is never more than 3 times longer than the UTF-8 it replaces (counting '&' as "and").
+*/
+bool FoldCodePoint(const uint32_t code_point, const char*& folded, size_t& folded_size);
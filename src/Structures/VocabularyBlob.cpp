@@ -0,0 +1,129 @@
+#include <cstring>
+#include <iostream>
+
+#include "VocabularyBlob.h"
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#define VOCABULARY_BLOB_BLOCK_SIZE (static_cast<size_t>(32))
+#elif defined(__SSE2__)
+#include <emmintrin.h>
+#define VOCABULARY_BLOB_BLOCK_SIZE (static_cast<size_t>(16))
+#endif
+
+#define VOCABULARY_BLOB_PADDING (static_cast<size_t>(32))    // at least one block, so that the last positions of the blob can be loaded as a whole block
+
+#ifdef VOCABULARY_BLOB_BLOCK_SIZE
+/*
+* A bitmask with bit i set if first_bytes[i] == first and last_bytes[i] == last.
+*/
+static inline uint32_t CandidateBlock(const char* first_bytes, const char* last_bytes, const char first, const char last)
+{
+#if defined(__AVX2__)
+    const __m256i f = _mm256_cmpeq_epi8(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(first_bytes)), _mm256_set1_epi8(first));
+    const __m256i l = _mm256_cmpeq_epi8(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(last_bytes)), _mm256_set1_epi8(last));
+    return static_cast<uint32_t>(_mm256_movemask_epi8(_mm256_and_si256(f, l)));
+#else
+    const __m128i f = _mm_cmpeq_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i*>(first_bytes)), _mm_set1_epi8(first));
+    const __m128i l = _mm_cmpeq_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i*>(last_bytes)), _mm_set1_epi8(last));
+    return static_cast<uint32_t>(_mm_movemask_epi8(_mm_and_si128(f, l)));
+#endif
+}
+#endif
+
+VocabularyBlob::VocabularyBlob(const vector<pair<string, int64_t>>& words)
+{
+    size_t size = 0;
+    for (const auto& word : words)
+    {
+        if (word.first.size() > VOCABULARY_BLOB_MAX_WORD_SIZE)
+        {
+            cerr << "VocabularyBlob() - The word '" << word.first << "' is longer than " << VOCABULARY_BLOB_MAX_WORD_SIZE << " bytes. The vocabulary will not be scanned." << endl;
+            return;
+        }
+        size += word.first.size() + 1;
+    }
+
+    blob.reserve(size + VOCABULARY_BLOB_PADDING);
+    word_ids.reserve(words.size());
+
+    for (const auto& word : words)
+    {
+        blob.push_back(static_cast<char>(static_cast<uint8_t>(word.first.size())));
+        blob.append(word.first);
+        word_ids.push_back(word.second);
+    }
+    blob_size = blob.size();
+    blob.append(VOCABULARY_BLOB_PADDING, '\0');
+}
+
+void VocabularyBlob::FindContaining(const string_view s, vector<int64_t>& ids) const
+{
+    ids.clear();
+    if (s.empty() || word_ids.empty() || s.size() > blob_size)
+    {
+        return;
+    }
+
+    const char* data = blob.data();
+    const size_t m = s.size();
+    const size_t last_position = blob_size - m;   // where the last possible match starts
+
+    size_t word = 0;                                                // the first word that doesn't end before the current candidate
+    size_t word_begin = 1;                                          // of its bytes, after its length
+    size_t word_end = word_begin + static_cast<uint8_t>(data[0]);
+
+    /*
+    * Called with the positions whose first and last bytes match, in increasing order, so the words are walked once per scan.
+    */
+    auto Verify = [&](const size_t position)
+    {
+        if (m > 2 && memcmp(data + position + 1, s.data() + 1, m - 2) != 0)
+        {
+            return;
+        }
+
+        while (position >= word_end)
+        {
+            ++word;
+            word_begin = word_end + 1;
+            word_end = word_begin + static_cast<uint8_t>(data[word_end]);
+        }
+
+        if (position < word_begin || position + m > word_end)
+        {
+            return;     // it starts at the length of the word, or runs into the next word
+        }
+
+        if (ids.empty() || ids.back() != word_ids[word])
+        {
+            ids.push_back(word_ids[word]);   // a word that contains s more than once is only added once
+        }
+    };
+
+#ifdef VOCABULARY_BLOB_BLOCK_SIZE
+    for (size_t i = 0; i <= last_position; i += VOCABULARY_BLOB_BLOCK_SIZE)
+    {
+        uint32_t candidates = CandidateBlock(data + i, data + i + m - 1, s.front(), s.back());
+
+        if (last_position - i < VOCABULARY_BLOB_BLOCK_SIZE - 1)
+        {
+            candidates &= (1u << (last_position - i + 1)) - 1;    // the last block runs past last_position
+        }
+
+        while (candidates != 0)
+        {
+            Verify(i + static_cast<size_t>(__builtin_ctz(candidates)));
+            candidates &= candidates - 1;
+        }
+    }
+#else
+    for (size_t i = 0; i <= last_position; ++i)
+    {
+        if (data[i] == s.front() && data[i + m - 1] == s.back())
+        {
+            Verify(i);
+        }
+    }
+#endif
+}
@@ -0,0 +1,45 @@
+#pragma once
+
+#define VOCABULARY_BLOB_MAX_WORD_SIZE (static_cast<size_t>(255))   // bytes. A word's length is stored in one byte
+
+#include <cstdint>
+#include <cstddef>
+#include <string>
+#include <string_view>
+#include <vector>
+#include <utility>
+
+using namespace std;
+
+/*
+* The vocabulary (the Words table) as one contiguous blob, each word stored as its length (one byte) followed by its bytes,
+* for finding the words that contain a string by scanning all of them. No index: building it is one copy of the words,
+* and it's only about 1 byte per word bigger than the words themselves (plus their ids), so appending a word is as cheap as it gets.
+*
+* The scan compares 16 (SSE2) or 32 (AVX2) positions of the blob at a time with the string's first byte, and the positions m - 1 bytes later
+* with its last byte. Only the positions where both match are compared in full, and then checked to be inside one word.
+*/
+class VocabularyBlob
+{
+public:
+    VocabularyBlob() {}
+
+    /*
+    * words[i].first has the id words[i].second. If a word is longer than VOCABULARY_BLOB_MAX_WORD_SIZE, the blob is left empty.
+    */
+    VocabularyBlob(const vector<pair<string, int64_t>>& words);
+
+    bool empty() const { return word_ids.empty(); }
+
+    /*
+    * Replaces ids with the ids of the words that contain s (including s itself, if it's a word), in the order of the words.
+    */
+    void FindContaining(const string_view s, vector<int64_t>& ids) const;
+
+    size_t MemoryUsage() const { return blob.size() + word_ids.size() * sizeof(int64_t); }
+
+protected:
+    string blob;                // the words, each after its length, then VOCABULARY_BLOB_PADDING zero bytes so that the scan can load past the end
+    size_t blob_size = 0;       // without the padding
+    vector<int64_t> word_ids;   // the id of each word, in the order of the blob
+};
@@ -0,0 +1,149 @@
+#include <algorithm>
+#include <cstring>
+#include <iostream>
+
+#include "VocabularyHash.h"
+
+/*
+* The splitmix64 finalizer: every bit of the input affects every bit of the output.
+*/
+static inline uint64_t Mix(uint64_t x)
+{
+    x ^= x >> 30;
+    x *= 0xBF58476D1CE4E5B9ull;
+    x ^= x >> 27;
+    x *= 0x94D049BB133111EBull;
+    x ^= x >> 31;
+    return x;
+}
+
+/*
+* Maps x to [0, n) with a multiply and a shift, instead of a division.
+*/
+static inline uint32_t Reduce(const uint32_t x, const size_t n)
+{
+    return static_cast<uint32_t>((static_cast<uint64_t>(x) * n) >> 32);
+}
+
+uint64_t VocabularyHash::Hash(const string_view word)
+{
+    uint64_t hash = 0x9E3779B97F4A7C15ull ^ word.size();
+    size_t i = 0;
+
+    for (; i + 8 <= word.size(); i += 8)
+    {
+        uint64_t chunk;
+        memcpy(&chunk, word.data() + i, 8);
+        hash = Mix(hash ^ chunk);
+    }
+
+    uint64_t tail = 0;
+    if (i < word.size())
+    {
+        memcpy(&tail, word.data() + i, word.size() - i);
+    }
+    return Mix(hash ^ tail);
+}
+
+uint32_t VocabularyHash::Bucket(const uint64_t hash) const
+{
+    return Reduce(static_cast<uint32_t>(hash), seeds.size());
+}
+
+uint32_t VocabularyHash::Slot(const uint64_t hash, const uint32_t seed) const
+{
+    return Reduce(static_cast<uint32_t>(Mix(hash ^ (static_cast<uint64_t>(seed) * 0x9E3779B97F4A7C15ull))), ids.size());
+}
+
+VocabularyHash::VocabularyHash(const vector<pair<string, int64_t>>& words) : valid{false}
+{
+    const size_t n = words.size();
+
+    seeds.assign(n / VOCABULARY_HASH_BUCKET_SIZE + 1, 0);
+    fingerprints.assign(n, 0);
+    ids.assign(n, -1);
+
+    vector<uint64_t> hashes(n);
+    vector<vector<uint32_t>> buckets(seeds.size()); // the words of each bucket, by index into words
+
+    for (size_t i = 0; i < n; ++i)
+    {
+        hashes[i] = Hash(words[i].first);
+        buckets[Bucket(hashes[i])].push_back(static_cast<uint32_t>(i));
+    }
+
+    vector<uint32_t> order(buckets.size());
+    for (size_t b = 0; b < buckets.size(); ++b)
+    {
+        order[b] = static_cast<uint32_t>(b);
+    }
+    stable_sort(order.begin(), order.end(), [&](const uint32_t a, const uint32_t b) { return buckets[a].size() > buckets[b].size(); });
+
+    vector<bool> taken(n, false);
+    vector<uint32_t> slots;
+
+    for (const uint32_t b : order)
+    {
+        const vector<uint32_t>& bucket = buckets[b];
+        if (bucket.empty())
+        {
+            break; // the rest are empty too
+        }
+
+        bool placed = false;
+
+        for (uint32_t seed = 0; seed < VOCABULARY_HASH_MAX_SEED && !placed; ++seed)
+        {
+            slots.clear();
+            placed = true;
+
+            for (const uint32_t i : bucket)
+            {
+                const uint32_t slot = Slot(hashes[i], seed);
+
+                if (taken[slot] || find(slots.begin(), slots.end(), slot) != slots.end())
+                {
+                    placed = false;
+                    break;
+                }
+                slots.push_back(slot);
+            }
+
+            if (placed)
+            {
+                seeds[b] = seed;
+            }
+        }
+
+        if (!placed)
+        {
+            cerr << "VocabularyHash() - Could not find a seed for a bucket of " << bucket.size() << " words, eg. '" << words[bucket[0]].first << "'. Exact matches will not be pre-checked." << endl;
+            seeds.clear();
+            fingerprints.clear();
+            ids.clear();
+            return;
+        }
+
+        for (size_t k = 0; k < bucket.size(); ++k)
+        {
+            taken[slots[k]] = true;
+            fingerprints[slots[k]] = static_cast<uint32_t>(hashes[bucket[k]] >> 32);
+            ids[slots[k]] = words[bucket[k]].second;
+        }
+    }
+
+    valid = true;
+}
+
+int64_t VocabularyHash::Find(const string_view word) const
+{
+    if (ids.empty())
+    {
+        return -1;
+    }
+
+    const uint64_t hash = Hash(word);
+    const uint32_t slot = Slot(hash, seeds[Bucket(hash)]);
+
+    return (fingerprints[slot] == static_cast<uint32_t>(hash >> 32)) ? ids[slot] : -1;
+}
@@ -0,0 +1,59 @@
+#pragma once
+
+#define VOCABULARY_HASH_BUCKET_SIZE 4                   // average words per bucket. Each bucket stores one seed, so larger buckets use less memory, but take longer to build
+#define VOCABULARY_HASH_MAX_SEED (1u << 24)             // seeds tried per bucket before building fails (eg. two words with the same 64 bit hash can never be separated)
+
+#include <cstdint>
+#include <cstddef>
+#include <string>
+#include <string_view>
+#include <vector>
+#include <utility>
+
+using namespace std;
+
+/*
+* A minimal perfect hash of the vocabulary (the Words table), from a normalized word to its word id.
+*
+* The words are hashed into buckets, and each bucket gets a seed that sends each of its words to a distinct slot (hash and displace):
+* the buckets with the most words are placed first, while most slots are free, and the seed is found by trying 0, 1, 2, ...
+* There are exactly as many slots as words, so a lookup is one hash of the word and two array reads (the seed, then the slot).
+*
+* A word that isn't in the vocabulary also lands in some slot, so each slot stores a 32 bit fingerprint of its word's hash to tell them apart.
+* A word that isn't in the vocabulary is found anyway once in 2^32 lookups, which is harmless as long as it's only used to skip work.
+*/
+class VocabularyHash
+{
+public:
+    VocabularyHash() : valid{false} {}
+
+    /*
+    * words[i].first has the id words[i].second. The words must be distinct.
+    */
+    VocabularyHash(const vector<pair<string, int64_t>>& words);
+
+    /*
+    * False if the words couldn't be hashed (see VOCABULARY_HASH_MAX_SEED), or if the hash was never built.
+    */
+    bool isValid() const { return valid; }
+
+    /*
+    * The word's id, or -1 if the word isn't in the vocabulary. Always -1 if !isValid().
+    */
+    int64_t Find(const string_view word) const;
+
+    size_t size() const { return ids.size(); }
+
+    size_t MemoryUsage() const { return seeds.size() * sizeof(uint32_t) + fingerprints.size() * sizeof(uint32_t) + ids.size() * sizeof(int64_t); }
+
+protected:
+    static uint64_t Hash(const string_view word);
+
+    uint32_t Bucket(const uint64_t hash) const;
+    uint32_t Slot(const uint64_t hash, const uint32_t seed) const;
+
+    vector<uint32_t> seeds;         // per bucket
+    vector<uint32_t> fingerprints;  // per slot, the high 32 bits of the hash of the slot's word
+    vector<int64_t> ids;            // per slot
+    bool valid;
+};
@@ -0,0 +1,104 @@
+#include <algorithm>
+#include <cstring>
+
+#include "VocabularySuffixArray.h"
+
+VocabularySuffixArray::VocabularySuffixArray(const vector<pair<string, int64_t>>& words)
+{
+    size_t text_size = 0;
+    for (const auto& word : words)
+    {
+        text_size += word.first.size() + 1;
+    }
+
+    text.reserve(text_size);
+    suffixes.reserve(text_size - words.size());
+    word_starts.reserve(words.size());
+    word_ids.reserve(words.size());
+
+    for (const auto& word : words)
+    {
+        word_starts.push_back(static_cast<uint32_t>(text.size()));
+        word_ids.push_back(word.second);
+
+        for (size_t i = 0; i < word.first.size(); ++i)
+        {
+            suffixes.push_back(static_cast<uint32_t>(text.size() + i));
+        }
+        text.append(word.first).push_back('\0');
+    }
+
+    /*
+    * Every suffix ends at its word's '\0', so strcmp() compares exactly the part of the suffix that can be matched.
+    */
+    const char* data = text.data();
+    sort(suffixes.begin(), suffixes.end(), [data](const uint32_t a, const uint32_t b) { return strcmp(data + a, data + b) < 0; });
+}
+
+pair<size_t, size_t> VocabularySuffixArray::Range(const string_view s) const
+{
+    const char* data = text.data();
+
+    /*
+    * Compares the first s.size() bytes of the suffix with s. A suffix that's shorter than s stops at its '\0', which is less than any byte of s.
+    */
+    auto Compare = [&](const uint32_t position) -> int
+    {
+        return strncmp(data + position, s.data(), s.size());
+    };
+
+    const auto first = lower_bound(suffixes.begin(), suffixes.end(), s, [&](const uint32_t position, const string_view) { return Compare(position) < 0; });
+    const auto last = upper_bound(first, suffixes.end(), s, [&](const string_view, const uint32_t position) { return Compare(position) > 0; });
+
+    return {static_cast<size_t>(first - suffixes.begin()), static_cast<size_t>(last - suffixes.begin())};
+}
+
+int64_t VocabularySuffixArray::WordIdAt(const uint32_t position) const
+{
+    const size_t word = static_cast<size_t>(upper_bound(word_starts.begin(), word_starts.end(), position) - word_starts.begin()) - 1;
+    return word_ids[word];
+}
+
+void VocabularySuffixArray::FindContaining(const string_view s, vector<int64_t>& ids) const
+{
+    ids.clear();
+    if (s.empty())
+    {
+        return;
+    }
+
+    const pair<size_t, size_t> range = Range(s);
+    ids.reserve(range.second - range.first);
+
+    for (size_t i = range.first; i < range.second; ++i)
+    {
+        ids.push_back(WordIdAt(suffixes[i]));
+    }
+
+    /*
+    * A word that contains s more than once (eg. "ana" in "banana") is in the range once per occurrence.
+    */
+    sort(ids.begin(), ids.end());
+    ids.erase(unique(ids.begin(), ids.end()), ids.end());
+}
+
+void VocabularySuffixArray::FindEndingWith(const string_view s, vector<int64_t>& ids) const
+{
+    ids.clear();
+    if (s.empty())
+    {
+        return;
+    }
+
+    const pair<size_t, size_t> range = Range(s);
+
+    for (size_t i = range.first; i < range.second; ++i)
+    {
+        if (text[suffixes[i] + s.size()] == '\0')
+        {
+            ids.push_back(WordIdAt(suffixes[i]));
+        }
+    }
+
+    sort(ids.begin(), ids.end()); // a word only ends with s once
+}
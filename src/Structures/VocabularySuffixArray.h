@@ -0,0 +1,58 @@
+#pragma once
+
+#include <cstdint>
+#include <cstddef>
+#include <string>
+#include <string_view>
+#include <vector>
+#include <utility>
+
+using namespace std;
+
+/*
+* A suffix array over the vocabulary (the Words table), for finding the words that contain (or end with) a string without testing every word.
+*
+* The words are concatenated into one text, each followed by a '\0', and every position inside a word is a suffix. The suffixes are sorted
+* (comparing up to the end of their word, since a match can't cross into the next word), so the suffixes that begin with a string are one
+* range of the array, found with two binary searches in O(m log n) for a string of m bytes, and each suffix in the range is in a matching word.
+*/
+class VocabularySuffixArray
+{
+public:
+    VocabularySuffixArray() {}
+
+    /*
+    * words[i].first has the id words[i].second. The words must not contain '\0'.
+    */
+    VocabularySuffixArray(const vector<pair<string, int64_t>>& words);
+
+    bool empty() const { return suffixes.empty(); }
+
+    /*
+    * Replaces ids with the ids of the words that contain s (including s itself, if it's a word), in increasing order.
+    */
+    void FindContaining(const string_view s, vector<int64_t>& ids) const;
+
+    /*
+    * Replaces ids with the ids of the words that end with s (including s itself, if it's a word), in increasing order.
+    */
+    void FindEndingWith(const string_view s, vector<int64_t>& ids) const;
+
+    size_t MemoryUsage() const { return text.size() + suffixes.size() * sizeof(uint32_t) + word_starts.size() * sizeof(uint32_t) + word_ids.size() * sizeof(int64_t); }
+
+protected:
+    /*
+    * The range [first, last) of suffixes that begin with s.
+    */
+    pair<size_t, size_t> Range(const string_view s) const;
+
+    /*
+    * The id of the word that contains text[position].
+    */
+    int64_t WordIdAt(const uint32_t position) const;
+
+    string text;                    // the words, each followed by a '\0'
+    vector<uint32_t> suffixes;      // the positions of text that are inside a word, in the order of the suffixes that start there
+    vector<uint32_t> word_starts;   // the position of each word in text
+    vector<int64_t> word_ids;       // the id of each word
+};
@@ -1,26 +1,94 @@
 #include "WordMatch.h"
+#include "SortedSetKernels.h"
+
+/*
+* Paragraph ids are sqlite rowids, which fit in 32 bits for any corpus that fits on a phone.
+*/
+static vector<uint32_t> ParagraphIds(const vector<ParagraphMatch>& data)
+{
+    vector<uint32_t> ids;
+    ids.reserve(data.size());
+
+    for (const ParagraphMatch& match : data)
+    {
+        ids.push_back(static_cast<uint32_t>(match.paragraph_id));
+    }
+    return ids;
+}
+
+static PostingList EncodeParagraphIds(const vector<ParagraphMatch>& data)
+{
+    const vector<uint32_t> ids = ParagraphIds(data);
+    return PostingList(ids.data(), ids.size());
+}
+
+static vector<uint32_t> DecodeParagraphIds(const PostingList& list)
+{
+    vector<uint32_t> ids(((list.size() + POSTING_LIST_BLOCK_SIZE - 1) / POSTING_LIST_BLOCK_SIZE) * POSTING_LIST_BLOCK_SIZE);   // DecodeBlock() writes a whole block
+
+    size_t n = 0;
+    for (size_t b = 0; n < list.size(); ++b)
+    {
+        n += list.DecodeBlock(b, ids.data() + n);
+    }
+    ids.resize(n);
+    return ids;
+}
 
 WordMatch::WordMatch(
-    const string&                                           in_normalized_word, 
+    const string_view                                       in_normalized_word, 
     const vector<int64_t>&                                  in_partial_match_idxs,
-    const vector<tuple<int64_t, string, vector<int64_t>>>&  in_partial_match_data) noexcept :
+    const vector<ParagraphMatch>&                           in_partial_match_data,
+    const double                                            in_partial_match_max_score,
+    const bool                                              in_partial_matches_skipped,
+    const bool                                              in_fuzzy_matches_skipped) noexcept :
         normalized_word(in_normalized_word), 
         exact_match_idx(-1), 
         exact_match_data({}), 
         partial_match_idxs(in_partial_match_idxs),
-        partial_match_data(in_partial_match_data) {}
+        partial_match_data(in_partial_match_data),
+        fuzzy_match_idxs({}),
+        fuzzy_match_data({}),
+        fuzzy_match_distances({}),
+        exact_match_max_score(0.0),
+        partial_match_max_score(in_partial_match_max_score),
+        fuzzy_match_max_score(0.0),
+        exact_match_paragraph_ids(),
+        partial_match_paragraph_ids(EncodeParagraphIds(in_partial_match_data)),
+        fuzzy_match_paragraph_ids(),
+        partial_matches_skipped(in_partial_matches_skipped),
+        fuzzy_matches_skipped(in_fuzzy_matches_skipped) {}
 
 WordMatch::WordMatch(
-    const string&                                           in_normalized_word, 
+    const string_view                                       in_normalized_word, 
     const int64_t&                                          in_exact_match_idx, 
-    const vector<tuple<int64_t, string, vector<int64_t>>>&  in_exact_match_data, 
+    const vector<ParagraphMatch>&                           in_exact_match_data, 
+    const double                                            in_exact_match_max_score,
     const vector<int64_t>&                                  in_partial_match_idxs, 
-    const vector<tuple<int64_t, string, vector<int64_t>>>&  in_partial_match_data) noexcept :
+    const vector<ParagraphMatch>&                           in_partial_match_data,
+    const double                                            in_partial_match_max_score,
+    const vector<int64_t>&                                  in_fuzzy_match_idxs, 
+    const vector<ParagraphMatch>&                           in_fuzzy_match_data,
+    const vector<uint8_t>&                                  in_fuzzy_match_distances,
+    const double                                            in_fuzzy_match_max_score,
+    const bool                                              in_partial_matches_skipped,
+    const bool                                              in_fuzzy_matches_skipped) noexcept :
         normalized_word(in_normalized_word), 
         exact_match_idx(in_exact_match_idx), 
         exact_match_data(in_exact_match_data), 
         partial_match_idxs(in_partial_match_idxs),
-        partial_match_data(in_partial_match_data) {}
+        partial_match_data(in_partial_match_data),
+        fuzzy_match_idxs(in_fuzzy_match_idxs),
+        fuzzy_match_data(in_fuzzy_match_data),
+        fuzzy_match_distances(in_fuzzy_match_distances),
+        exact_match_max_score(in_exact_match_max_score),
+        partial_match_max_score(in_partial_match_max_score),
+        fuzzy_match_max_score(in_fuzzy_match_max_score),
+        exact_match_paragraph_ids(EncodeParagraphIds(in_exact_match_data)),
+        partial_match_paragraph_ids(EncodeParagraphIds(in_partial_match_data)),
+        fuzzy_match_paragraph_ids(EncodeParagraphIds(in_fuzzy_match_data)),
+        partial_matches_skipped(in_partial_matches_skipped),
+        fuzzy_matches_skipped(in_fuzzy_matches_skipped) {}
 
 WordMatch::WordMatch(
     WordMatch&& other) noexcept : 
@@ -28,7 +96,18 @@ WordMatch::WordMatch(
         exact_match_idx(std::move(other.exact_match_idx)), 
         exact_match_data(std::move(other.exact_match_data)), 
         partial_match_idxs(std::move(other.partial_match_idxs)),
-        partial_match_data(std::move(other.partial_match_data)) {}
+        partial_match_data(std::move(other.partial_match_data)),
+        fuzzy_match_idxs(std::move(other.fuzzy_match_idxs)),
+        fuzzy_match_data(std::move(other.fuzzy_match_data)),
+        fuzzy_match_distances(std::move(other.fuzzy_match_distances)),
+        exact_match_max_score(other.exact_match_max_score),
+        partial_match_max_score(other.partial_match_max_score),
+        fuzzy_match_max_score(other.fuzzy_match_max_score),
+        exact_match_paragraph_ids(std::move(other.exact_match_paragraph_ids)),
+        partial_match_paragraph_ids(std::move(other.partial_match_paragraph_ids)),
+        fuzzy_match_paragraph_ids(std::move(other.fuzzy_match_paragraph_ids)),
+        partial_matches_skipped(other.partial_matches_skipped),
+        fuzzy_matches_skipped(other.fuzzy_matches_skipped) {}
 
 WordMatch::WordMatch(
     const WordMatch& other) noexcept : 
@@ -36,7 +115,38 @@ WordMatch::WordMatch(
     exact_match_idx(std::move(other.exact_match_idx)), 
     exact_match_data(std::move(other.exact_match_data)), 
     partial_match_idxs(std::move(other.partial_match_idxs)),
-    partial_match_data(std::move(other.partial_match_data)) {}
+    partial_match_data(std::move(other.partial_match_data)),
+    fuzzy_match_idxs(std::move(other.fuzzy_match_idxs)),
+    fuzzy_match_data(std::move(other.fuzzy_match_data)),
+    fuzzy_match_distances(std::move(other.fuzzy_match_distances)),
+    exact_match_max_score(other.exact_match_max_score),
+    partial_match_max_score(other.partial_match_max_score),
+    fuzzy_match_max_score(other.fuzzy_match_max_score),
+    exact_match_paragraph_ids(std::move(other.exact_match_paragraph_ids)),
+    partial_match_paragraph_ids(std::move(other.partial_match_paragraph_ids)),
+    fuzzy_match_paragraph_ids(std::move(other.fuzzy_match_paragraph_ids)),
+    partial_matches_skipped(other.partial_matches_skipped),
+    fuzzy_matches_skipped(other.fuzzy_matches_skipped) {}
+
+vector<uint32_t> WordMatch::MatchedParagraphIds() const
+{
+    const vector<uint32_t> exact_ids = DecodeParagraphIds(exact_match_paragraph_ids);
+    const vector<uint32_t> partial_ids = DecodeParagraphIds(partial_match_paragraph_ids);
+    const vector<uint32_t> fuzzy_ids = DecodeParagraphIds(fuzzy_match_paragraph_ids);
+
+    vector<uint32_t> exact_or_partial_ids(exact_ids.size() + partial_ids.size());
+    exact_or_partial_ids.resize(UnionSorted(exact_ids.data(), exact_ids.size(), partial_ids.data(), partial_ids.size(), exact_or_partial_ids.data()));
+
+    vector<uint32_t> ids(exact_or_partial_ids.size() + fuzzy_ids.size());
+    ids.resize(UnionSorted(exact_or_partial_ids.data(), exact_or_partial_ids.size(), fuzzy_ids.data(), fuzzy_ids.size(), ids.data()));
+    return ids;
+}
+
+RoaringBitmap WordMatch::ParagraphSet() const
+{
+    const vector<uint32_t> ids = MatchedParagraphIds();
+    return RoaringBitmap(ids.data(), ids.size());
+}
 
 WordMatch& WordMatch::operator=(const WordMatch& other) noexcept 
 { 
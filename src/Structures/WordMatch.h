@@ -1,11 +1,25 @@
 #pragma once
 
 #include <string>
+#include <string_view>
 #include <vector>
 #include <unordered_map>
 
+#include "ParagraphMatch.h"
+#include "PostingList.h"
+#include "RoaringBitmap.h"
+
 using namespace std;
 
+/*
+* How a word of the paragraph matched a query word.
+*/
+typedef enum : uint8_t {
+    EXACT_WORD_MATCH = 0,       // the query word itself
+    PARTIAL_WORD_MATCH = 1,     // a word that contains the query word (eg. "summit" for "summ")
+    FUZZY_WORD_MATCH = 2        // a word a few typos away from the query word (eg. "summit" for "sumit")
+} WordMatchClass;
+
 struct WordMatch
 {
     WordMatch() = delete;
@@ -14,16 +28,27 @@ struct WordMatch
     * For normal use
     */
     WordMatch(
-        const string&                                           in_normalized_word, 
+        const string_view                                       in_normalized_word, 
         const vector<int64_t>&                                  in_partial_match_idxs,
-        const vector<tuple<int64_t, string, vector<int64_t>>>&  in_partial_match_data) noexcept;
+        const vector<ParagraphMatch>&                           in_partial_match_data,
+        const double                                            in_partial_match_max_score,
+        const bool                                              in_partial_matches_skipped = false,
+        const bool                                              in_fuzzy_matches_skipped = false) noexcept;
 
     WordMatch(
-        const string&                                           in_normalized_word, 
+        const string_view                                       in_normalized_word, 
         const int64_t&                                          in_exact_match_idx, 
-        const vector<tuple<int64_t, string, vector<int64_t>>>&  in_exact_match_data, 
+        const vector<ParagraphMatch>&                           in_exact_match_data, 
+        const double                                            in_exact_match_max_score,
         const vector<int64_t>&                                  in_partial_match_idxs, 
-        const vector<tuple<int64_t, string, vector<int64_t>>>&  in_partial_match_data) noexcept;
+        const vector<ParagraphMatch>&                           in_partial_match_data,
+        const double                                            in_partial_match_max_score,
+        const vector<int64_t>&                                  in_fuzzy_match_idxs, 
+        const vector<ParagraphMatch>&                           in_fuzzy_match_data,
+        const vector<uint8_t>&                                  in_fuzzy_match_distances,
+        const double                                            in_fuzzy_match_max_score,
+        const bool                                              in_partial_matches_skipped = false,
+        const bool                                              in_fuzzy_matches_skipped = false) noexcept;
 
     /*
     * Added for vector opperations.
@@ -35,24 +60,64 @@ struct WordMatch
 
     bool foundExactMatch() const { return exact_match_idx >= 0; }
     bool foundPartialMatches() const { return !partial_match_idxs.empty(); }
+    bool foundFuzzyMatches() const { return !fuzzy_match_idxs.empty(); }
+
+    /*
+    * The ids of every paragraph that contains an exact, partial or fuzzy match of this query word, in increasing order, decoded from the paragraph id lists.
+    * Built on demand, since they're only needed to find the candidate paragraphs of phrases (see Search::findPhraseParagraphs()), which scoreProximity() checks again word by word.
+    */
+    vector<uint32_t> MatchedParagraphIds() const;
+
+    /*
+    * The same paragraphs, as a set.
+    */
+    RoaringBitmap ParagraphSet() const;
 
     const string normalized_word;
 
     const int64_t exact_match_idx;
 
+    const vector<ParagraphMatch> exact_match_data;
+
     /*
-    * get<0>(vector[i]) - paragraph id
-    * get<1>(vector[i]) - paragraph original text
-    * get<2>(vector[i]) - word ids, in the order that they appear in the paragraph
+    * Every word that matched in any paragraph of partial_match_data (the union of their matched_word_ids), in increasing order.
     */
-    const vector<tuple<int64_t, string, vector<int64_t>>> exact_match_data;
-
     const vector<int64_t> partial_match_idxs;
+    const vector<ParagraphMatch> partial_match_data;
+
+    /*
+    * Only looked up for a word that isn't in the vocabulary (see Search::getMatches()).
+    * fuzzy_match_idxs is the union of the matched_word_ids of fuzzy_match_data, in increasing order,
+    * and the closest matched word of fuzzy_match_data[i] is fuzzy_match_distances[i] edits away from normalized_word.
+    */
+    const vector<int64_t> fuzzy_match_idxs;
+    const vector<ParagraphMatch> fuzzy_match_data;
+    const vector<uint8_t> fuzzy_match_distances;
+
+    /*
+    * The highest BM25 score (see Search::scoreBM25()) of any paragraph in exact_match_data, partial_match_data and fuzzy_match_data. 
+    * Upper bounds for top-K ranking, computed once when the word is looked up.
+    */
+    const double exact_match_max_score;
+    const double partial_match_max_score;
+    const double fuzzy_match_max_score;
+
+    /*
+    * The paragraph ids of exact_match_data, partial_match_data and fuzzy_match_data (they're in increasing order), for top-K ranking to walk and skip through
+    * a block at a time without touching the ParagraphMatches. The i'th id is the paragraph_id of the i'th ParagraphMatch.
+    * They're an index over the ParagraphMatches, which still hold their paragraph_id, so they add to a WordMatch's memory rather than save any.
+    */
+    const PostingList exact_match_paragraph_ids;
+    const PostingList partial_match_paragraph_ids;
+    const PostingList fuzzy_match_paragraph_ids;
+
+    /*
+    * True if only exact matches were looked up (eg. for a stop word), so the partial matches are empty regardless of the vocabulary.
+    */
+    const bool partial_matches_skipped;
 
     /*
-    * get<0>(vector[i]) - paragraph id
-    * get<1>(vector[i]) - paragraph original text
-    * get<2>(vector[i]) - word ids, in the order that they appear in the paragraph
+    * True if the word may have had fuzzy matches, but they weren't looked up because the word was still being typed and had partial matches (see Search::getMatches()).
     */
-    const vector<tuple<int64_t, string, vector<int64_t>>> partial_match_data;
+    const bool fuzzy_matches_skipped;
 };
\ No newline at end of file
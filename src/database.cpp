@@ -1,4 +1,5 @@
 #include <iostream>
+#include <algorithm>
 
 #ifdef DATABASE_LOG_EXECUTION_TIMES
 #include <chrono>
@@ -9,7 +10,9 @@
 #include "../extern/yaml-cpp/include/yaml-cpp/yaml.h"
 
 #include "Structures/NormalizedText.h"
+#include "Structures/DocumentChunker.h"
 
+#include "DDL/table_documents.h"
 #include "DDL/table_words.h"
 #include "DDL/table_paragraphs.h"
 #include "DDL/table_words_to_paragraphs.h"
@@ -19,6 +22,12 @@ Database* Database::Instance = nullptr;
 sqlite3* Database::db_mainThread = nullptr;
 sqlite3* Database::db_backgroundThread = nullptr;
 bool Database::bIsValid = true;
+int64_t Database::paragraph_count = 0;
+double Database::average_paragraph_word_count = 0.0;
+VocabularyHash Database::vocabulary;
+VocabularySuffixArray Database::vocabulary_suffixes;
+VocabularyBlob Database::vocabulary_blob;
+SortedVocabulary Database::vocabulary_sorted;
 
 
 Database::Database()
@@ -60,6 +69,15 @@ Database::Database()
         return;
     }
 
+    rc = sqlite3_exec(db_mainThread, DDL_CREATE_TABLE_IF_NOT_EXISTS_DOCUMENTS, 0, 0, &errMsg);
+    if (rc != SQLITE_OK) 
+    {
+        cerr << "Err: " << rc << " SQL error: " << errMsg << endl;
+        sqlite3_free(errMsg);
+        bIsValid = false;
+        return;
+    }
+
     rc = sqlite3_exec(db_mainThread, DDL_CREATE_TABLE_IF_NOT_EXISTS_PARAGRAPHS, 0, 0, &errMsg);
     if (rc != SQLITE_OK) 
     {
@@ -90,13 +108,6 @@ Database::Database()
         return;
     }
 
-    vector<NormalizedText> buffer;
-
-    for (const auto& data : yamlTestData)
-    {
-        buffer.push_back(NormalizedText(data.as<string>(), MAX_PARAGRAPH_SIZE));
-    }
-
 #ifdef DATABASE_LOG_EXECUTION_TIMES
     chrono::_V2::system_clock::time_point t0  = chrono::_V2::system_clock::time_point();
     chrono::_V2::system_clock::time_point t1  = chrono::_V2::system_clock::time_point();
@@ -110,6 +121,7 @@ Database::Database()
     */
     const string LoadTestDataTransactionName = "Load Test Data";
 
+    sqlite3_stmt* stmt_insert_document = nullptr;
     sqlite3_stmt* stmt_insert_paragraph = nullptr;
     sqlite3_stmt* stmt_insert_word = nullptr;
     sqlite3_stmt* stmt_select_word = nullptr;
@@ -117,6 +129,7 @@ Database::Database()
 
     auto CommitTransaction = [&]() -> bool
     {
+        sqlite3_finalize(stmt_insert_document);
         sqlite3_finalize(stmt_insert_paragraph);
         sqlite3_finalize(stmt_insert_word);
         sqlite3_finalize(stmt_select_word);
@@ -130,6 +143,13 @@ Database::Database()
         return;
     }
 
+    rc = sqlite3_prepare_v3(db_mainThread, DML_INSERT_DOCUMENT, -1, SQLITE_PREPARE_PERSISTENT, &stmt_insert_document, 0);
+    if (rc != SQLITE_OK) 
+    {
+        FailTransaction(LoadTestDataTransactionName, rc, "Failed to prepare insert statement for documents", true, CommitTransaction);
+        return;
+    }
+
     rc = sqlite3_prepare_v3(db_mainThread, DML_INSERT_PARAGRAPH, -1, SQLITE_PREPARE_PERSISTENT, &stmt_insert_paragraph, 0);
     if (rc != SQLITE_OK) 
     {
@@ -158,149 +178,237 @@ Database::Database()
         return;
     }
 
+    int64_t document_id;
     int paragraph_id;
     int word_id;
 
-    for (const NormalizedText& normalized_text : buffer) 
+    /*
+    * Documents are normalized and inserted one chunk at a time, into the same NormalizedText, so the longest document only costs its chunks' worth of memory.
+    */
+    NormalizedText normalized_text;
+    string reversed_word;   // reused for every word, see Words.reversed_word
+
+    for (const auto& data : yamlTestData)
     {
+        const string& document = data.Scalar();
+
+        if (document.empty())
+        {
+            continue;
+        }
+
         /*
-        * Paragraphs Table - Begin Insert
+        * Documents Table - Begin Insert
         */
-        paragraph_id = -1;
+        document_id = -1;
 
-        rc = sqlite3_bind_text(stmt_insert_paragraph, 1, normalized_text.original_text.c_str(), -1, SQLITE_STATIC);
+        rc = sqlite3_bind_int64(stmt_insert_document, 1, static_cast<int64_t>(document.size()));
         if (rc != SQLITE_OK) 
         {
-            FailTransaction(LoadTestDataTransactionName, rc, "Failed to bind text to prepared statement for paragraphs", true, CommitTransaction);
+            FailTransaction(LoadTestDataTransactionName, rc, "Failed to bind int to prepared statement for documents", true, CommitTransaction);
             return;
         }
 
-        sqlite3_bind_text(stmt_insert_paragraph, 2, normalized_text.normalized_text.c_str(), -1, SQLITE_STATIC);
+        rc = sqlite3_step(stmt_insert_document);
+        if (rc != SQLITE_DONE) 
+        {
+            cerr << "Err: " << rc << " Unexpected event during transaction '" << LoadTestDataTransactionName << "': Failed to insert document" << " - " << sqlite3_errmsg(db_mainThread) << endl;
+        } else
+        {
+            document_id = sqlite3_last_insert_rowid(db_mainThread);
+        }
+
+        rc = sqlite3_reset(stmt_insert_document);
         if (rc != SQLITE_OK) 
         {
-            FailTransaction(LoadTestDataTransactionName, rc, "Failed to bind text to prepared statement for paragraphs", true, CommitTransaction);
+            FailTransaction(LoadTestDataTransactionName, rc, "Failed to reset prepared statement for documents", true, CommitTransaction);
             return;
         }
 
-        rc = sqlite3_step(stmt_insert_paragraph);
-        if (rc != SQLITE_DONE) 
+        if (document_id == -1)
         {
-            cerr << "Err: " << rc << " Unexpected event during transaction '" << LoadTestDataTransactionName << "': Failed to insert paragraph" << " - " << sqlite3_errmsg(db_mainThread) << endl;
-        } else
+            continue;
+        }
+
+        DocumentChunker chunker(document.data(), document.size(), MAX_PARAGRAPH_SIZE);
+
+        while (chunker.Next())
         {
-            paragraph_id = static_cast<int>(sqlite3_last_insert_rowid(db_mainThread));
+            normalized_text.Assign(chunker.chunk.data(), chunker.chunk.size(), MAX_PARAGRAPH_SIZE);
 
-            for (size_t i = 0; i < normalized_text.normalized_words.size(); ++i)
+            if (normalized_text.wordCount() == 0)
             {
-                /*
-                * Words Table - Begin Insert
-                */
-                const string& word = normalized_text.normalized_words[i];
-                word_id = -1;
-
-                rc = sqlite3_bind_text(stmt_insert_word, 1, word.c_str(), -1, SQLITE_STATIC);
-                if (rc != SQLITE_OK) 
-                {
-                    FailTransaction(LoadTestDataTransactionName, rc, "Failed to bind text to prepared statement for words", true, CommitTransaction);
-                    return;
-                }
+                continue; // eg. a chunk of punctuation
+            }
 
-                rc = sqlite3_step(stmt_insert_word);
-                if (rc == SQLITE_CONSTRAINT) 
-                {
-                    /*
-                    * Words Table - Begin Select
-                    */
-                    rc = sqlite3_bind_text(stmt_select_word, 1, word.c_str(), -1, SQLITE_STATIC);
-                    if (rc != SQLITE_OK) 
-                    {
-                        FailTransaction(LoadTestDataTransactionName, rc, "Failed to bind text to prepared statement for words", true, CommitTransaction);
-                        return;
-                    }
+            /*
+            * Paragraphs Table - Begin Insert
+            */
+            paragraph_id = -1;
 
-                    rc = sqlite3_step(stmt_select_word);
-                    if (rc == SQLITE_ROW) 
-                    {
-                        word_id = sqlite3_column_int64(stmt_select_word, 0);
-                    } else if (rc == SQLITE_DONE)
-                    {
-                        cerr << "Err: " << rc << " Unexpected event during transaction '" << LoadTestDataTransactionName << "': Failed to instert word AND failed select word. This should be impossible." << " - " << sqlite3_errmsg(db_mainThread) << endl;
-                    } else 
-                    {
-                        cerr << "Err: " << rc << " Unexpected event during transaction '" << LoadTestDataTransactionName << "': Failed to select word" << " - " << sqlite3_errmsg(db_mainThread) << endl;
-                    }
+            rc = sqlite3_bind_int64(stmt_insert_paragraph, 1, document_id);
+            if (rc != SQLITE_OK) 
+            {
+                FailTransaction(LoadTestDataTransactionName, rc, "Failed to bind int to prepared statement for paragraphs", true, CommitTransaction);
+                return;
+            }
 
-                    rc = sqlite3_reset(stmt_select_word);
-                    if (rc != SQLITE_OK) 
-                    {
-                        FailTransaction(LoadTestDataTransactionName, rc, "Failed to reset prepared statement for words", true, CommitTransaction);
-                        return;
-                    }
-                } else if (rc == SQLITE_DONE || rc == SQLITE_OK) 
-                {
-                    word_id = static_cast<int>(sqlite3_last_insert_rowid(db_mainThread));
-                } else 
-                {
-                    cerr << "Err: " << rc << " Unexpected event during transaction '" << LoadTestDataTransactionName << "': Failed to insert word" << " - " << sqlite3_errmsg(db_mainThread) << endl;
-                }
+            rc = sqlite3_bind_int64(stmt_insert_paragraph, 2, static_cast<int64_t>(chunker.chunk_offset));
+            if (rc != SQLITE_OK) 
+            {
+                FailTransaction(LoadTestDataTransactionName, rc, "Failed to bind int to prepared statement for paragraphs", true, CommitTransaction);
+                return;
+            }
 
-                rc = sqlite3_reset(stmt_insert_word);
-                if (rc != SQLITE_OK && rc != SQLITE_CONSTRAINT) 
-                {
-                    FailTransaction(LoadTestDataTransactionName, rc, "Failed to reset prepared statement for words", true, CommitTransaction);
-                    return;
-                }
+            rc = sqlite3_bind_text(stmt_insert_paragraph, 3, normalized_text.original_text.c_str(), -1, SQLITE_STATIC);
+            if (rc != SQLITE_OK) 
+            {
+                FailTransaction(LoadTestDataTransactionName, rc, "Failed to bind text to prepared statement for paragraphs", true, CommitTransaction);
+                return;
+            }
 
-                if (paragraph_id == -1 || word_id == -1)
-                {
-                    cerr << "Err: " << rc << " Failed to insert to words to paragraphs due to not having a valid (word_id, paragraph_id): (" << (word_id == -1 ? "missing" : "good") << ", " << (paragraph_id == -1 ? "missing" : "good") << ")" << endl;
-                } else
+            rc = sqlite3_bind_text(stmt_insert_paragraph, 4, normalized_text.normalized_text.c_str(), -1, SQLITE_STATIC);
+            if (rc != SQLITE_OK) 
+            {
+                FailTransaction(LoadTestDataTransactionName, rc, "Failed to bind text to prepared statement for paragraphs", true, CommitTransaction);
+                return;
+            }
+
+            rc = sqlite3_bind_int64(stmt_insert_paragraph, 5, static_cast<int64_t>(normalized_text.wordCount()));
+            if (rc != SQLITE_OK) 
+            {
+                FailTransaction(LoadTestDataTransactionName, rc, "Failed to bind int to prepared statement for paragraphs", true, CommitTransaction);
+                return;
+            }
+
+            rc = sqlite3_step(stmt_insert_paragraph);
+            if (rc != SQLITE_DONE) 
+            {
+                cerr << "Err: " << rc << " Unexpected event during transaction '" << LoadTestDataTransactionName << "': Failed to insert paragraph" << " - " << sqlite3_errmsg(db_mainThread) << endl;
+            } else
+            {
+                paragraph_id = static_cast<int>(sqlite3_last_insert_rowid(db_mainThread));
+
+                for (size_t i = 0; i < normalized_text.wordCount(); ++i)
                 {
                     /*
-                    * Words to Paragraphs Table - Begin Insert
+                    * Words Table - Begin Insert
                     */
-                    rc = sqlite3_bind_int(stmt_insert_words_to_paragraphs, 1, word_id);
-                    if (rc != SQLITE_OK) 
-                    {
-                        FailTransaction(LoadTestDataTransactionName, rc, "Failed to bind int to prepared statement for words to paragraphs", true, CommitTransaction);
-                        return;
-                    }
+                    const string_view word = normalized_text.word(i);
+                    word_id = -1;
 
-                    rc = sqlite3_bind_int(stmt_insert_words_to_paragraphs, 2, paragraph_id);
+                    rc = sqlite3_bind_text(stmt_insert_word, 1, word.data(), static_cast<int>(word.size()), SQLITE_STATIC);
                     if (rc != SQLITE_OK) 
                     {
-                        FailTransaction(LoadTestDataTransactionName, rc, "Failed to bind int to prepared statement for words to paragraphs", true, CommitTransaction);
+                        FailTransaction(LoadTestDataTransactionName, rc, "Failed to bind text to prepared statement for words", true, CommitTransaction);
                         return;
                     }
 
-                    rc = sqlite3_bind_int(stmt_insert_words_to_paragraphs, 3, i);
+                    reversed_word.assign(word.rbegin(), word.rend());
+                    rc = sqlite3_bind_text(stmt_insert_word, 2, reversed_word.data(), static_cast<int>(reversed_word.size()), SQLITE_STATIC);
                     if (rc != SQLITE_OK) 
                     {
-                        FailTransaction(LoadTestDataTransactionName, rc, "Failed to bind int to prepared statement for words to paragraphs", true, CommitTransaction);
+                        FailTransaction(LoadTestDataTransactionName, rc, "Failed to bind text to prepared statement for words", true, CommitTransaction);
                         return;
                     }
 
-                    rc = sqlite3_step(stmt_insert_words_to_paragraphs);
-                    if (rc != SQLITE_DONE && rc != SQLITE_CONSTRAINT) 
+                    rc = sqlite3_step(stmt_insert_word);
+                    if (rc == SQLITE_CONSTRAINT) 
                     {
-                        cerr << "Err: " << rc << " Unexpected event during transaction '" << LoadTestDataTransactionName << "': Failed to insert row to words to paragraphs" << " - " << sqlite3_errmsg(db_mainThread) << endl;
+                        /*
+                        * Words Table - Begin Select
+                        */
+                        rc = sqlite3_bind_text(stmt_select_word, 1, word.data(), static_cast<int>(word.size()), SQLITE_STATIC);
+                        if (rc != SQLITE_OK) 
+                        {
+                            FailTransaction(LoadTestDataTransactionName, rc, "Failed to bind text to prepared statement for words", true, CommitTransaction);
+                            return;
+                        }
+
+                        rc = sqlite3_step(stmt_select_word);
+                        if (rc == SQLITE_ROW) 
+                        {
+                            word_id = sqlite3_column_int64(stmt_select_word, 0);
+                        } else if (rc == SQLITE_DONE)
+                        {
+                            cerr << "Err: " << rc << " Unexpected event during transaction '" << LoadTestDataTransactionName << "': Failed to instert word AND failed select word. This should be impossible." << " - " << sqlite3_errmsg(db_mainThread) << endl;
+                        } else 
+                        {
+                            cerr << "Err: " << rc << " Unexpected event during transaction '" << LoadTestDataTransactionName << "': Failed to select word" << " - " << sqlite3_errmsg(db_mainThread) << endl;
+                        }
+
+                        rc = sqlite3_reset(stmt_select_word);
+                        if (rc != SQLITE_OK) 
+                        {
+                            FailTransaction(LoadTestDataTransactionName, rc, "Failed to reset prepared statement for words", true, CommitTransaction);
+                            return;
+                        }
+                    } else if (rc == SQLITE_DONE || rc == SQLITE_OK) 
+                    {
+                        word_id = static_cast<int>(sqlite3_last_insert_rowid(db_mainThread));
+                    } else 
+                    {
+                        cerr << "Err: " << rc << " Unexpected event during transaction '" << LoadTestDataTransactionName << "': Failed to insert word" << " - " << sqlite3_errmsg(db_mainThread) << endl;
                     }
 
-                    rc = sqlite3_reset(stmt_insert_words_to_paragraphs);
+                    rc = sqlite3_reset(stmt_insert_word);
                     if (rc != SQLITE_OK && rc != SQLITE_CONSTRAINT) 
                     {
-                        FailTransaction(LoadTestDataTransactionName, rc, "Failed to reset prepared statement for words to paragraphs", true, CommitTransaction);
+                        FailTransaction(LoadTestDataTransactionName, rc, "Failed to reset prepared statement for words", true, CommitTransaction);
                         return;
                     }
+
+                    if (paragraph_id == -1 || word_id == -1)
+                    {
+                        cerr << "Err: " << rc << " Failed to insert to words to paragraphs due to not having a valid (word_id, paragraph_id): (" << (word_id == -1 ? "missing" : "good") << ", " << (paragraph_id == -1 ? "missing" : "good") << ")" << endl;
+                    } else
+                    {
+                        /*
+                        * Words to Paragraphs Table - Begin Insert
+                        */
+                        rc = sqlite3_bind_int(stmt_insert_words_to_paragraphs, 1, word_id);
+                        if (rc != SQLITE_OK) 
+                        {
+                            FailTransaction(LoadTestDataTransactionName, rc, "Failed to bind int to prepared statement for words to paragraphs", true, CommitTransaction);
+                            return;
+                        }
+
+                        rc = sqlite3_bind_int(stmt_insert_words_to_paragraphs, 2, paragraph_id);
+                        if (rc != SQLITE_OK) 
+                        {
+                            FailTransaction(LoadTestDataTransactionName, rc, "Failed to bind int to prepared statement for words to paragraphs", true, CommitTransaction);
+                            return;
+                        }
+
+                        rc = sqlite3_bind_int(stmt_insert_words_to_paragraphs, 3, i);
+                        if (rc != SQLITE_OK) 
+                        {
+                            FailTransaction(LoadTestDataTransactionName, rc, "Failed to bind int to prepared statement for words to paragraphs", true, CommitTransaction);
+                            return;
+                        }
+
+                        rc = sqlite3_step(stmt_insert_words_to_paragraphs);
+                        if (rc != SQLITE_DONE && rc != SQLITE_CONSTRAINT) 
+                        {
+                            cerr << "Err: " << rc << " Unexpected event during transaction '" << LoadTestDataTransactionName << "': Failed to insert row to words to paragraphs" << " - " << sqlite3_errmsg(db_mainThread) << endl;
+                        }
+
+                        rc = sqlite3_reset(stmt_insert_words_to_paragraphs);
+                        if (rc != SQLITE_OK && rc != SQLITE_CONSTRAINT) 
+                        {
+                            FailTransaction(LoadTestDataTransactionName, rc, "Failed to reset prepared statement for words to paragraphs", true, CommitTransaction);
+                            return;
+                        }
+                    }
                 }
             }
-        }
 
-        rc = sqlite3_reset(stmt_insert_paragraph);
-        if (rc != SQLITE_OK) 
-        {
-            FailTransaction(LoadTestDataTransactionName, rc, "Failed to reset prepared statement for paragraphs", true, CommitTransaction);
-            return;
+            rc = sqlite3_reset(stmt_insert_paragraph);
+            if (rc != SQLITE_OK) 
+            {
+                FailTransaction(LoadTestDataTransactionName, rc, "Failed to reset prepared statement for paragraphs", true, CommitTransaction);
+                return;
+            }
         }
     }
 
@@ -332,8 +440,29 @@ Database::Database()
         return;
     }
 
+    rc = sqlite3_finalize(stmt_insert_document);
+    if (rc != SQLITE_OK) 
+    {
+        FailTransaction(LoadTestDataTransactionName, rc, "Failed to finalize prepared statement for documents", true, CommitTransaction);
+        return;
+    }
+
+    /*
+    * Words Table - Begin Update
+    * Every paragraph is inserted, so each word's document frequency can be counted in one pass.
+    */
+    rc = sqlite3_exec(db_mainThread, DML_UPDATE_WORDS_DOCUMENT_FREQUENCY, 0, 0, &errMsg);
+    if (rc != SQLITE_OK) 
+    {
+        cerr << "Err: " << rc << " SQL error: " << errMsg << endl;
+        sqlite3_free(errMsg);
+        FailTransaction(LoadTestDataTransactionName, rc, "Failed to update the document frequencies of words", true, CommitTransaction);
+        return;
+    }
+
     if (!EndTransaction(LoadTestDataTransactionName, true))
     {
+        sqlite3_finalize(stmt_insert_document);
         sqlite3_finalize(stmt_insert_paragraph);
         sqlite3_finalize(stmt_insert_word);
         sqlite3_finalize(stmt_select_word);
@@ -409,6 +538,238 @@ Database::Database()
     cout << "Time taken to analyze data: " << duration.count() << " microseconds" << endl;
 #endif
 #endif
+
+    if (!LoadParagraphStatistics())
+    {
+        bIsValid = false;
+        return;
+    }
+
+    LoadVocabulary(); // if this fails, every word is looked up with sql, as before
+}
+
+bool Database::LoadParagraphStatistics()
+{
+    sqlite3_stmt* stmt = nullptr;
+
+    int rc = sqlite3_prepare_v2(db_mainThread, DML_SELECT_PARAGRAPH_STATISTICS, -1, &stmt, 0);
+    if (rc != SQLITE_OK) 
+    {
+        cerr << "Err: " << rc << " Failed to prepare select statement for paragraph statistics: " << sqlite3_errmsg(db_mainThread) << endl;
+        sqlite3_finalize(stmt);
+        return false;
+    }
+
+    rc = sqlite3_step(stmt);
+    if (rc != SQLITE_ROW) 
+    {
+        cerr << "Err: " << rc << " Failed to select paragraph statistics: " << sqlite3_errmsg(db_mainThread) << endl;
+        sqlite3_finalize(stmt);
+        return false;
+    }
+
+    paragraph_count = sqlite3_column_int64(stmt, 0);
+    average_paragraph_word_count = sqlite3_column_double(stmt, 1); // NULL (0.0) if there are no paragraphs
+
+    sqlite3_finalize(stmt);
+    return true;
+}
+
+bool Database::LoadVocabulary()
+{
+#ifdef DATABASE_LOG_EXECUTION_TIMES
+    chrono::_V2::system_clock::time_point t0  = chrono::_V2::system_clock::time_point();
+    chrono::_V2::system_clock::time_point t1  = chrono::_V2::system_clock::time_point();
+
+    t0  = chrono::high_resolution_clock::now();
+#endif
+    sqlite3_stmt* stmt = nullptr;
+
+    int rc = sqlite3_prepare_v2(db_mainThread, DML_SELECT_ID_WORD_FROM_WORDS, -1, &stmt, 0);
+    if (rc != SQLITE_OK) 
+    {
+        cerr << "Err: " << rc << " Failed to prepare select statement for the vocabulary: " << sqlite3_errmsg(db_mainThread) << endl;
+        sqlite3_finalize(stmt);
+        return false;
+    }
+
+    vector<pair<string, int64_t>> words;
+
+    while ((rc = sqlite3_step(stmt)) == SQLITE_ROW)
+    {
+        words.emplace_back(
+            string(reinterpret_cast<const char*>(sqlite3_column_text(stmt, 1)), static_cast<size_t>(sqlite3_column_bytes(stmt, 1))), 
+            sqlite3_column_int64(stmt, 0)
+        );
+    }
+    sqlite3_finalize(stmt);
+
+    if (rc != SQLITE_DONE) 
+    {
+        cerr << "Err: " << rc << " Failed to select the vocabulary: " << sqlite3_errmsg(db_mainThread) << endl;
+        return false;
+    }
+
+    vocabulary = VocabularyHash(words);
+    vocabulary_suffixes = VocabularySuffixArray(words);
+    vocabulary_blob = VocabularyBlob(words);
+    vocabulary_sorted = SortedVocabulary(words);
+
+#ifdef DATABASE_LOG_EXECUTION_TIMES
+    t1  = chrono::high_resolution_clock::now();
+    auto duration = chrono::duration_cast<chrono::microseconds>(t1 - t0);
+    cout << "Time taken to hash the vocabulary (" << vocabulary.size() << " words, " << vocabulary.MemoryUsage() << " bytes), sort its suffixes (" << vocabulary_suffixes.MemoryUsage() << " bytes) and words (" << vocabulary_sorted.MemoryUsage() << " bytes), and copy it to a blob (" << vocabulary_blob.MemoryUsage() << " bytes): " << duration.count() << " microseconds" << endl;
+#endif
+    return vocabulary.isValid();
+}
+
+void Database::FindSimilarWords(const string_view normalized_word, const uint8_t max_distance, vector<pair<int64_t, uint8_t>>& similar_words)
+{
+    similar_words.clear();
+
+    const LevenshteinAutomaton automaton(normalized_word, max_distance);
+    vector<pair<size_t, uint8_t>> accepted;
+    vocabulary_sorted.FindAccepted(automaton, accepted);
+
+    for (const pair<size_t, uint8_t>& word : accepted)
+    {
+        if (vocabulary_sorted.Word(word.first).find(normalized_word) == string::npos)
+        {
+            similar_words.push_back({vocabulary_sorted.Id(word.first), word.second});
+        }
+    }
+    sort(similar_words.begin(), similar_words.end());
+}
+
+#ifdef DATABASE_BENCHMARK_CONTAINS
+void Database::BenchmarkContains(sqlite3* db, const string_view normalized_word)
+{
+    chrono::_V2::system_clock::time_point t0  = chrono::_V2::system_clock::time_point();
+    chrono::_V2::system_clock::time_point t1  = chrono::_V2::system_clock::time_point();
+    chrono::_V2::system_clock::time_point t2  = chrono::_V2::system_clock::time_point();
+    chrono::_V2::system_clock::time_point t3  = chrono::_V2::system_clock::time_point();
+
+    vector<int64_t> like_ids;
+    vector<int64_t> suffix_array_ids;
+    vector<int64_t> scan_ids;
+
+    t0  = chrono::high_resolution_clock::now();
+
+    sqlite3_stmt* stmt = nullptr;
+    const pmr::string pattern = LikePattern(normalized_word, CONTAINS);
+
+    int rc = sqlite3_prepare_v2(db, DML_SELECT_ID_FROM_WORDS_WHERE_WORD_LIKE, -1, &stmt, 0);
+    if (rc == SQLITE_OK)
+    {
+        rc = sqlite3_bind_text(stmt, 1, pattern.data(), static_cast<int>(pattern.size()), SQLITE_STATIC);
+    }
+    while (rc == SQLITE_OK && (rc = sqlite3_step(stmt)) == SQLITE_ROW)
+    {
+        like_ids.push_back(sqlite3_column_int64(stmt, 0));
+        rc = SQLITE_OK;
+    }
+    if (rc != SQLITE_DONE) 
+    {
+        cerr << "Err: " << rc << " Failed to benchmark LIKE for '" << normalized_word << "': " << sqlite3_errmsg(db) << endl;
+    }
+    sqlite3_finalize(stmt);
+
+    t1  = chrono::high_resolution_clock::now();
+    vocabulary_suffixes.FindContaining(normalized_word, suffix_array_ids);
+    t2  = chrono::high_resolution_clock::now();
+    vocabulary_blob.FindContaining(normalized_word, scan_ids);
+    t3  = chrono::high_resolution_clock::now();
+
+    sort(like_ids.begin(), like_ids.end());
+    sort(scan_ids.begin(), scan_ids.end());
+
+    cout << "Words containing '" << normalized_word << "': " << like_ids.size() << " with LIKE in " << chrono::duration_cast<chrono::microseconds>(t1 - t0).count() << " microseconds, " 
+         << suffix_array_ids.size() << " with the suffix array in " << chrono::duration_cast<chrono::microseconds>(t2 - t1).count() << " microseconds, " 
+         << scan_ids.size() << " with the vocabulary scan in " << chrono::duration_cast<chrono::microseconds>(t3 - t2).count() << " microseconds" 
+         << ((like_ids == suffix_array_ids && like_ids == scan_ids) ? "" : " (MISMATCH)") << endl;
+}
+#endif
+
+pmr::string Database::LikePattern(const string_view normalized_word, const TextQueryType Type, pmr::memory_resource* Resource)
+{
+    pmr::string pattern(Resource);
+    pattern.reserve(normalized_word.size() + 2);
+
+    switch (Type)
+    {
+        case EXACT_MATCH:
+        {
+            pattern.append(normalized_word);
+            break;
+        }
+        case BEGINS_WITH:
+        {
+            pattern.append(normalized_word).append("%");
+            break;
+        }
+        case ENDS_WITH:
+        {
+            pattern.append("%").append(normalized_word);
+            break;
+        }
+        case CONTAINS:
+        {
+            pattern.append("%").append(normalized_word).append("%");
+            break;
+        }
+    }
+    return pattern;
+}
+
+bool Database::PrefixSuccessor(const string_view prefix, pmr::string& successor)
+{
+    successor.assign(prefix.data(), prefix.size());
+
+    while (!successor.empty() && static_cast<unsigned char>(successor.back()) == 0xFF)
+    {
+        successor.pop_back();
+    }
+
+    if (successor.empty())
+    {
+        return false;
+    }
+
+    successor.back() = static_cast<char>(static_cast<unsigned char>(successor.back()) + 1);
+    return true;
+}
+
+int Database::BindWordPattern(sqlite3_stmt* stmt, const int first_index, const string_view normalized_word, const TextQueryType Type, pmr::string& pattern, pmr::string& upper_bound)
+{
+    switch (Type)
+    {
+        case BEGINS_WITH:
+        case ENDS_WITH:
+        {
+            pattern.assign(normalized_word.data(), normalized_word.size());
+            if (Type == ENDS_WITH)
+            {
+                reverse(pattern.begin(), pattern.end());
+            }
+
+            const int rc = sqlite3_bind_text(stmt, first_index, pattern.data(), static_cast<int>(pattern.size()), SQLITE_STATIC);
+            if (rc != SQLITE_OK)
+            {
+                return rc;
+            }
+
+            if (PrefixSuccessor(pattern, upper_bound))
+            {
+                return sqlite3_bind_text(stmt, first_index + 1, upper_bound.data(), static_cast<int>(upper_bound.size()), SQLITE_STATIC);
+            }
+            return sqlite3_bind_zeroblob(stmt, first_index + 1, 0); // sqlite orders every TEXT value before every BLOB, so this bound excludes nothing
+        }
+        default:
+        {
+            pattern = LikePattern(normalized_word, Type, pattern.get_allocator().resource());
+            return sqlite3_bind_text(stmt, first_index, pattern.data(), static_cast<int>(pattern.size()), SQLITE_STATIC);
+        }
+    }
 }
 
 Database* Database::Get() 
@@ -469,7 +830,7 @@ bool Database::isValid() const
     return bIsValid;
 }
 
-bool Database::ExplainWordsTableQueryPlan(const string& normalized_word, const TextQueryType Type) 
+bool Database::ExplainWordsTableQueryPlan(const string_view normalized_word, const TextQueryType Type) 
 {
     int rc = 0;
 
@@ -486,12 +847,12 @@ bool Database::ExplainWordsTableQueryPlan(const string& normalized_word, const T
             }
             case BEGINS_WITH:
             {
-                rc = sqlite3_prepare_v2(db_mainThread, DML_EXPLAIN_QUERY_PLAN_DML_SELECT_ID_FROM_WORDS_WHERE_WORD_LIKE, -1, &stmt, 0);
+                rc = sqlite3_prepare_v2(db_mainThread, DML_EXPLAIN_QUERY_PLAN_DML_SELECT_ID_FROM_WORDS_WHERE_WORD_IN_RANGE, -1, &stmt, 0);
                 break;
             }
             case ENDS_WITH:
             {
-                rc = sqlite3_prepare_v2(db_mainThread, DML_EXPLAIN_QUERY_PLAN_DML_SELECT_ID_FROM_WORDS_WHERE_WORD_LIKE, -1, &stmt, 0);
+                rc = sqlite3_prepare_v2(db_mainThread, DML_EXPLAIN_QUERY_PLAN_DML_SELECT_ID_FROM_WORDS_WHERE_REVERSED_WORD_IN_RANGE, -1, &stmt, 0);
                 break;
             }
             case CONTAINS:
@@ -508,29 +869,10 @@ bool Database::ExplainWordsTableQueryPlan(const string& normalized_word, const T
         }
 
 
-        switch (Type)
-        {
-            case EXACT_MATCH:
-            {
-                rc = sqlite3_bind_text(stmt, 1, normalized_word.c_str(), -1, SQLITE_STATIC);
-                break;
-            }
-            case BEGINS_WITH:
-            {
-                rc = sqlite3_bind_text(stmt, 1, (normalized_word + "%").c_str(), -1, SQLITE_STATIC);
-                break;
-            }
-            case ENDS_WITH:
-            {
-                rc = sqlite3_bind_text(stmt, 1, ("%" + normalized_word).c_str(), -1, SQLITE_STATIC);
-                break;
-            }
-            case CONTAINS:
-            {
-                rc = sqlite3_bind_text(stmt, 1, ("%" + normalized_word + "%").c_str(), -1, SQLITE_STATIC);
-                break;
-            }
-        }
+        pmr::string pattern;        // bound with SQLITE_STATIC, so they must outlive the statement
+        pmr::string upper_bound;
+
+        rc = BindWordPattern(stmt, 1, normalized_word, Type, pattern, upper_bound);
         if (rc != SQLITE_OK) 
         {
             cerr << "Err: " << rc << " Failed to bind text to the explain query plan statement for words: " << sqlite3_errmsg(db_mainThread) << endl;
@@ -556,7 +898,7 @@ bool Database::ExplainWordsTableQueryPlan(const string& normalized_word, const T
                 cout << "Opcode: " << opcode << " | Detail: " << detail << endl;
             } else if (rc != SQLITE_DONE) 
             {
-                cerr << "Err: " << rc << " Error while explaining query plan for word '" << normalized_word.c_str() << "': " << sqlite3_errmsg(db_mainThread) << endl;
+                cerr << "Err: " << rc << " Error while explaining query plan for word '" << normalized_word << "': " << sqlite3_errmsg(db_mainThread) << endl;
                 break;
             }
 
@@ -564,7 +906,7 @@ bool Database::ExplainWordsTableQueryPlan(const string& normalized_word, const T
 
         if (rc != SQLITE_DONE) 
         {
-            cerr << "Err: " << rc << " Error while explaining query plan for word '" << normalized_word.c_str() << "': " << sqlite3_errmsg(db_mainThread) << endl;
+            cerr << "Err: " << rc << " Error while explaining query plan for word '" << normalized_word << "': " << sqlite3_errmsg(db_mainThread) << endl;
         }
 
         sqlite3_finalize(stmt);
@@ -573,7 +915,7 @@ bool Database::ExplainWordsTableQueryPlan(const string& normalized_word, const T
     return false;
 }
 
-vector<int64_t> Database::QueryWordsTableReturnIds(const string& normalized_word, const TextQueryType Type)
+vector<int64_t> Database::QueryWordsTableReturnIds(const string_view normalized_word, const TextQueryType Type)
 {
     int rc = 0;
 
@@ -598,12 +940,12 @@ vector<int64_t> Database::QueryWordsTableReturnIds(const string& normalized_word
             }
             case BEGINS_WITH:
             {
-                rc = sqlite3_prepare_v2(db_mainThread, DML_SELECT_ID_FROM_WORDS_WHERE_WORD_LIKE, -1, &stmt, 0);
+                rc = sqlite3_prepare_v2(db_mainThread, DML_SELECT_ID_FROM_WORDS_WHERE_WORD_IN_RANGE, -1, &stmt, 0);
                 break;
             }
             case ENDS_WITH:
             {
-                rc = sqlite3_prepare_v2(db_mainThread, DML_SELECT_ID_FROM_WORDS_WHERE_WORD_LIKE, -1, &stmt, 0);
+                rc = sqlite3_prepare_v2(db_mainThread, DML_SELECT_ID_FROM_WORDS_WHERE_REVERSED_WORD_IN_RANGE, -1, &stmt, 0);
                 break;
             }
             case CONTAINS:
@@ -619,29 +961,10 @@ vector<int64_t> Database::QueryWordsTableReturnIds(const string& normalized_word
             return results;
         }
 
-        switch (Type)
-        {
-            case EXACT_MATCH:
-            {
-                rc = sqlite3_bind_text(stmt, 1, normalized_word.c_str(), -1, SQLITE_STATIC);
-                break;
-            }
-            case BEGINS_WITH:
-            {
-                rc = sqlite3_bind_text(stmt, 1, (normalized_word + "%").c_str(), -1, SQLITE_STATIC);
-                break;
-            }
-            case ENDS_WITH:
-            {
-                rc = sqlite3_bind_text(stmt, 1, ("%" + normalized_word).c_str(), -1, SQLITE_STATIC);
-                break;
-            }
-            case CONTAINS:
-            {
-                rc = sqlite3_bind_text(stmt, 1, ("%" + normalized_word + "%").c_str(), -1, SQLITE_STATIC);
-                break;
-            }
-        }
+        pmr::string pattern;        // bound with SQLITE_STATIC, so they must outlive the statement
+        pmr::string upper_bound;
+
+        rc = BindWordPattern(stmt, 1, normalized_word, Type, pattern, upper_bound);
         if (rc != SQLITE_OK) 
         {
             cerr << "Err: " << rc << " Failed to bind text to the query statement for words: " << sqlite3_errmsg(db_mainThread) << endl;
@@ -664,14 +987,14 @@ vector<int64_t> Database::QueryWordsTableReturnIds(const string& normalized_word
                 results.push_back(id);
             } else if (rc != SQLITE_DONE) 
             {
-                cerr << "Err: " << rc << " Error while querying word '" << normalized_word.c_str() << "': " << sqlite3_errmsg(db_mainThread) << endl;
+                cerr << "Err: " << rc << " Error while querying word '" << normalized_word << "': " << sqlite3_errmsg(db_mainThread) << endl;
             }
 
         } while (rc == SQLITE_ROW);
 
         if (rc != SQLITE_DONE) 
         {
-            cerr << "Err: " << rc << " Error while querying word '" << normalized_word.c_str() << "': " << sqlite3_errmsg(db_mainThread) << endl;
+            cerr << "Err: " << rc << " Error while querying word '" << normalized_word << "': " << sqlite3_errmsg(db_mainThread) << endl;
         }
 
 #ifdef DATABASE_LOG_EXECUTION_TIMES
@@ -692,18 +1015,53 @@ vector<int64_t> Database::QueryWordsTableReturnIds(const string& normalized_word
     return results;
 }
 
-vector<tuple<int64_t, string, int64_t, vector<int64_t>>> Database::GetAll_ParagraphId_ParagraphOriginalText_MatchedWordId_OrderedWordsInParagraphIds(const string& normalized_word, const TextQueryType Type, const bool UseBackgroundThread)
+vector<ParagraphMatch> Database::GetAll_ParagraphId_ParagraphOriginalText_MatchedWordId_OrderedWordsInParagraphIds(const string_view normalized_word, const TextQueryType Type, const bool UseBackgroundThread, const CancellationToken* Token)
 {
     int rc = 0;
-    vector<tuple<int64_t, string, int64_t, vector<int64_t>>> results = {};
+    vector<ParagraphMatch> results = {};
 
-    if (normalized_word.empty())
+    if (normalized_word.empty() || (Token && Token->isCancelled()))
     {
         return results;
     }
 
     sqlite3* db = UseBackgroundThread ? db_backgroundThread : db_mainThread;
 
+#ifdef DATABASE_BENCHMARK_CONTAINS
+    if (Type == CONTAINS)
+    {
+        BenchmarkContains(db, normalized_word);
+    }
+#endif
+    /*
+    * CONTAINS and ENDS_WITH find their words in the vocabulary's suffix array (or, for CONTAINS, by scanning the vocabulary blob),
+    * and query them by id, instead of sqlite testing every word with LIKE (CONTAINS can't use an index).
+    */
+#ifdef DATABASE_CONTAINS_SCAN
+    const bool scan_vocabulary = Type == CONTAINS && !vocabulary_blob.empty();
+#else
+    const bool scan_vocabulary = false;
+#endif
+    const bool use_suffix_array = !scan_vocabulary && (Type == CONTAINS || Type == ENDS_WITH) && !vocabulary_suffixes.empty();
+
+    if (scan_vocabulary || use_suffix_array)
+    {
+        vector<int64_t> word_ids;
+        if (scan_vocabulary)
+        {
+            vocabulary_blob.FindContaining(normalized_word, word_ids);
+        }
+        else if (Type == CONTAINS)
+        {
+            vocabulary_suffixes.FindContaining(normalized_word, word_ids);
+        }
+        else
+        {
+            vocabulary_suffixes.FindEndingWith(normalized_word, word_ids);
+        }
+        return GetAll_ParagraphId_ParagraphOriginalText_MatchedWordId_OrderedWordsInParagraphIds(normalized_word, word_ids, UseBackgroundThread, Token);
+    }
+
 #ifdef DATABASE_LOG_EXECUTION_TIMES
     chrono::_V2::system_clock::time_point t0  = chrono::_V2::system_clock::time_point();
     chrono::_V2::system_clock::time_point t1  = chrono::_V2::system_clock::time_point();
@@ -721,12 +1079,12 @@ vector<tuple<int64_t, string, int64_t, vector<int64_t>>> Database::GetAll_Paragr
         }
         case BEGINS_WITH:
         {
-            rc = sqlite3_prepare_v2(db, DML_SELECT_COMPOUND_1_LIKE, -1, &stmt, 0);
+            rc = sqlite3_prepare_v2(db, DML_SELECT_COMPOUND_1_WORD_IN_RANGE, -1, &stmt, 0);
             break;
         }
         case ENDS_WITH:
         {
-            rc = sqlite3_prepare_v2(db, DML_SELECT_COMPOUND_1_LIKE, -1, &stmt, 0);
+            rc = sqlite3_prepare_v2(db, DML_SELECT_COMPOUND_1_REVERSED_WORD_IN_RANGE, -1, &stmt, 0);
             break;
         }
         case CONTAINS:
@@ -742,7 +1100,7 @@ vector<tuple<int64_t, string, int64_t, vector<int64_t>>> Database::GetAll_Paragr
         return results;
     }
 
-    rc = sqlite3_bind_text(stmt, 1, normalized_word.c_str(), -1, SQLITE_STATIC);
+    rc = sqlite3_bind_text(stmt, 1, normalized_word.data(), static_cast<int>(normalized_word.size()), SQLITE_STATIC);
     if (rc != SQLITE_OK) 
     {
         cerr << "Err: " << rc << " Failed to bind text to the query statement for words to paragraphs: " << sqlite3_errmsg(db) << endl;
@@ -750,27 +1108,99 @@ vector<tuple<int64_t, string, int64_t, vector<int64_t>>> Database::GetAll_Paragr
         return results;
     }
 
-    switch (Type)
+    /*
+    * Built on the stack (unless the word is longer than MAX_WORD_SIZE), since this runs for every word of every keystroke.
+    * Bound with SQLITE_STATIC, so it must outlive the statement.
+    */
+    char pattern_buffer[2 * (MAX_WORD_SIZE + 3)];   // the pattern (the word, 2 wildcards and the terminator) and the upper bound of a range
+    pmr::monotonic_buffer_resource pattern_resource(pattern_buffer, sizeof(pattern_buffer));
+    pmr::string pattern(&pattern_resource);
+    pmr::string upper_bound(&pattern_resource);
+
+    if (Type != EXACT_MATCH)
     {
-        case EXACT_MATCH:
-        {
-            break;
-        }
-        case BEGINS_WITH:
-        {
-            rc = sqlite3_bind_text(stmt, 2, (normalized_word + "%").c_str(), -1, SQLITE_STATIC);
-            break;
-        }
-        case ENDS_WITH:
-        {
-            rc = sqlite3_bind_text(stmt, 2, ("%" + normalized_word).c_str(), -1, SQLITE_STATIC);
-            break;
-        }
-        case CONTAINS:
+        rc = BindWordPattern(stmt, 2, normalized_word, Type, pattern, upper_bound);
+    }
+    if (rc != SQLITE_OK) 
+    {
+        cerr << "Err: " << rc << " Failed to bind text to the query statement for words to paragraphs: " << sqlite3_errmsg(db) << endl;
+        sqlite3_finalize(stmt);
+        return results;
+    }
+
+#ifdef DATABASE_LOG_PREPARED_STATEMENTS
+    const char* prepared_statement = sqlite3_expanded_sql(stmt);
+    cout << prepared_statement << endl;
+#endif
+
+    results = ReadParagraphMatches(db, stmt, Token, rc);
+
+#ifdef DATABASE_LOG_EXECUTION_TIMES
+    t1  = chrono::high_resolution_clock::now();
+    auto duration = chrono::duration_cast<chrono::microseconds>(t1 - t0);
+    cout << "Time taken to " << (rc == SQLITE_INTERRUPT ? "cancel" : "query") << " words to paragraphs table on " << (UseBackgroundThread ? "background" : "main") << " thread: " << duration.count() << " microseconds" << endl;
+#endif
+#ifdef DATABASE_EXPLAIN_QUERY_PLANS
+    ExplainWordsTableQueryPlan(normalized_word, Type);
+    const int scanStepsCt = sqlite3_stmt_status(stmt, SQLITE_STMTSTATUS_FULLSCAN_STEP, 0);
+    const int sortCt = sqlite3_stmt_status(stmt, SQLITE_STMTSTATUS_SORT, 0);
+    const int autoIdxCt = sqlite3_stmt_status(stmt, SQLITE_STMTSTATUS_AUTOINDEX, 0);
+
+    cout << "Scan Steps: " << scanStepsCt << " Sort Count: " << sortCt << " Auto Index Count: " << autoIdxCt << endl;
+#endif
+    sqlite3_finalize(stmt);
+
+    return results;
+}
+
+vector<ParagraphMatch> Database::GetAll_ParagraphId_ParagraphOriginalText_MatchedWordId_OrderedWordsInParagraphIds(const string_view normalized_word, const vector<int64_t>& word_ids, const bool UseBackgroundThread, const CancellationToken* Token)
+{
+    int rc = 0;
+    vector<ParagraphMatch> results = {};
+
+    if (word_ids.empty() || (Token && Token->isCancelled()))
+    {
+        return results;
+    }
+
+    sqlite3* db = UseBackgroundThread ? db_backgroundThread : db_mainThread;
+
+#ifdef DATABASE_LOG_EXECUTION_TIMES
+    chrono::_V2::system_clock::time_point t0  = chrono::_V2::system_clock::time_point();
+    chrono::_V2::system_clock::time_point t1  = chrono::_V2::system_clock::time_point();
+
+    t0  = chrono::high_resolution_clock::now();
+#endif
+    /*
+    * The ids are passed to sqlite as a JSON array (see DML_SELECT_COMPOUND_1_WORD_IDS). Bound with SQLITE_STATIC, so it must outlive the statement.
+    */
+    string word_ids_json;
+    word_ids_json.reserve(word_ids.size() * 8 + 2);
+    word_ids_json.push_back('[');
+    for (size_t i = 0; i < word_ids.size(); ++i)
+    {
+        if (i > 0)
         {
-            rc = sqlite3_bind_text(stmt, 2, ("%" + normalized_word + "%").c_str(), -1, SQLITE_STATIC);
-            break;
+            word_ids_json.push_back(',');
         }
+        word_ids_json.append(to_string(word_ids[i]));
+    }
+    word_ids_json.push_back(']');
+
+    sqlite3_stmt* stmt = nullptr;
+
+    rc = sqlite3_prepare_v2(db, DML_SELECT_COMPOUND_1_WORD_IDS, -1, &stmt, 0);
+    if (rc != SQLITE_OK) 
+    {
+        cerr << "Err: " << rc << " Failed to prepare query statement for words to paragraphs: " << sqlite3_errmsg(db) << endl;
+        sqlite3_finalize(stmt);
+        return results;
+    }
+
+    rc = sqlite3_bind_text(stmt, 1, normalized_word.data(), static_cast<int>(normalized_word.size()), SQLITE_STATIC);
+    if (rc == SQLITE_OK)
+    {
+        rc = sqlite3_bind_text(stmt, 2, word_ids_json.data(), static_cast<int>(word_ids_json.size()), SQLITE_STATIC);
     }
     if (rc != SQLITE_OK) 
     {
@@ -784,86 +1214,92 @@ vector<tuple<int64_t, string, int64_t, vector<int64_t>>> Database::GetAll_Paragr
     cout << prepared_statement << endl;
 #endif
 
-    int64_t paragraph_id = -1;
-    string paragraph_text = "";
-    int64_t word_id = 0;
-    vector<int64_t> word_ids = {};
+    results = ReadParagraphMatches(db, stmt, Token, rc);
+
+#ifdef DATABASE_LOG_EXECUTION_TIMES
+    t1  = chrono::high_resolution_clock::now();
+    auto duration = chrono::duration_cast<chrono::microseconds>(t1 - t0);
+    cout << "Time taken to " << (rc == SQLITE_INTERRUPT ? "cancel" : "query") << " words to paragraphs table for " << word_ids.size() << " word ids on " << (UseBackgroundThread ? "background" : "main") << " thread: " << duration.count() << " microseconds" << endl;
+#endif
+    sqlite3_finalize(stmt);
+
+    return results;
+}
+
+vector<ParagraphMatch> Database::ReadParagraphMatches(sqlite3* db, sqlite3_stmt* stmt, const CancellationToken* Token, int& rc)
+{
+    vector<ParagraphMatch> results = {};
+
+    /*
+    * Each connection is only used by one thread at a time, so the handler can be installed for the duration of this statement.
+    * A non-zero return from the handler makes sqlite3_step() return SQLITE_INTERRUPT.
+    */
+    if (Token)
+    {
+        sqlite3_progress_handler(db, DATABASE_CANCELLATION_CHECK_INTERVAL, [](void* token) -> int 
+        {
+            return static_cast<const CancellationToken*>(token)->isCancelled() ? 1 : 0;
+        }, const_cast<CancellationToken*>(Token));
+    }
 
+    /*
+    * Rows are ordered by paragraph, then by word position, with one row per word in the paragraph.
+    * Consecutive rows of the same paragraph are collected into one ParagraphMatch.
+    */
     do
     {
         rc = sqlite3_step(stmt);
 
         if (rc == SQLITE_ROW) 
         {
-            int64_t p_id = sqlite3_column_int64(stmt, 0); 
-            const char* p_text = reinterpret_cast<const char*>(sqlite3_column_text(stmt, 1));
-            int64_t _w_id = sqlite3_column_int64(stmt, 2);
-            int64_t w_id = sqlite3_column_int64(stmt, 3);
+            const int64_t p_id = sqlite3_column_int64(stmt, 0); 
+            const int64_t w_id = sqlite3_column_int64(stmt, 3);
 
-            if (paragraph_id == -1) 
-            {
-                paragraph_id = p_id;
-                paragraph_text = p_text;
-                word_id = _w_id;
-                word_ids.push_back(w_id);
-            } else
+            if (results.empty() || results.back().paragraph_id != p_id)
             {
-                if (paragraph_id == p_id)
-                {
-                    word_ids.push_back(w_id);
-                } else
-                {
-                    results.push_back(tuple(paragraph_id, paragraph_text, word_id, word_ids));
-                    paragraph_id = p_id;
-                    paragraph_text = p_text;
-                    word_id = _w_id;
-                    word_ids = {w_id};
-                }
+                results.push_back(ParagraphMatch{
+                    p_id, 
+                    reinterpret_cast<const char*>(sqlite3_column_text(stmt, 1)), 
+                    sqlite3_column_int64(stmt, 2), 
+                    {}, 
+                    sqlite3_column_int64(stmt, 4), 
+                    static_cast<uint32_t>(sqlite3_column_int64(stmt, 5)), 
+                    static_cast<uint32_t>(sqlite3_column_int64(stmt, 6)),
+                    {}
+                });
             }
+            results.back().word_ids.push_back(w_id);
 
-        } else if (rc == SQLITE_DONE) 
-        {
-
-            if (paragraph_id != -1 && !word_ids.empty())
+            if (sqlite3_column_int(stmt, 7))
             {
-                if (results.empty())
-                {
-                    results.push_back(tuple(paragraph_id, paragraph_text, word_id, word_ids));
-                } else
+                vector<int64_t>& matched_word_ids = results.back().matched_word_ids;
+                const auto position = lower_bound(matched_word_ids.begin(), matched_word_ids.end(), w_id);
+
+                if (position == matched_word_ids.end() || *position != w_id)
                 {
-                    if (get<0>(results.back()) != paragraph_id)
-                    {
-                        results.push_back(tuple(paragraph_id, paragraph_text, word_id, word_ids));
-                    }
+                    matched_word_ids.insert(position, w_id);
                 }
-                
             }
-        } else
+
+        } else if (rc == SQLITE_INTERRUPT && Token && Token->isCancelled())
+        {
+            results.clear(); // the query was superseded, so its partial results are meaningless
+        } else if (rc != SQLITE_DONE)
         {
             cerr << "Err: " << rc << " Error while querying words to paragraphs: " << sqlite3_errmsg(db) << endl;
         }
 
     } while (rc == SQLITE_ROW);
 
-    if (rc != SQLITE_DONE) 
+    if (Token)
     {
-        cerr << "Err: " << rc << " Error while querying words to paragraphs: " << sqlite3_errmsg(db) << endl;
+        sqlite3_progress_handler(db, 0, nullptr, nullptr);
     }
 
-#ifdef DATABASE_LOG_EXECUTION_TIMES
-    t1  = chrono::high_resolution_clock::now();
-    auto duration = chrono::duration_cast<chrono::microseconds>(t1 - t0);
-    cout << "Time taken to query words to paragraphs table on " << (UseBackgroundThread ? "background" : "main") << " thread: " << duration.count() << " microseconds" << endl;
-#endif
-#ifdef DATABASE_EXPLAIN_QUERY_PLANS
-    ExplainWordsTableQueryPlan(normalized_word, Type);
-    const int scanStepsCt = sqlite3_stmt_status(stmt, SQLITE_STMTSTATUS_FULLSCAN_STEP, 0);
-    const int sortCt = sqlite3_stmt_status(stmt, SQLITE_STMTSTATUS_SORT, 0);
-    const int autoIdxCt = sqlite3_stmt_status(stmt, SQLITE_STMTSTATUS_AUTOINDEX, 0);
-
-    cout << "Scan Steps: " << scanStepsCt << " Sort Count: " << sortCt << " Auto Index Count: " << autoIdxCt << endl;
-#endif
-    sqlite3_finalize(stmt);
+    if (rc != SQLITE_DONE && rc != SQLITE_INTERRUPT) 
+    {
+        cerr << "Err: " << rc << " Error while querying words to paragraphs: " << sqlite3_errmsg(db) << endl;
+    }
 
     return results;
 }
@@ -4,16 +4,28 @@
 #define DATABASE_LOG_EXECUTION_TIMES    // uncomment this line to log execution times to the console
 // #define DATABASE_LOG_PREPARED_STATEMENTS    // uncomment this line to log prepared statements to the console before they are executed
 #define MAX_WORD_SIZE (static_cast<size_t>(45))
-#define MAX_PARAGRAPH_SIZE (static_cast<size_t>(200))
+#define MAX_PARAGRAPH_SIZE (static_cast<size_t>(200))     // documents are split into paragraphs (chunks) of at most this many bytes, see DocumentChunker
 #define LOAD_TEST_DATA        // uncomment this line to load test data into the database upon initialization
 #define ANALYZE_AFTER_LOAD    // uncomment this line to analyze the database to improve query speed after loading test data
+// #define DATABASE_CONTAINS_SCAN    // uncomment this line to find the words of CONTAINS queries by scanning the vocabulary blob, instead of searching its suffix array
+// #define DATABASE_BENCHMARK_CONTAINS    // uncomment this line to log the time each CONTAINS query takes to find its words with LIKE, the suffix array and the vocabulary scan
+#define DATABASE_CANCELLATION_CHECK_INTERVAL 1000   // number of virtual machine instructions sqlite runs between checks of a query's cancellation token
 
 #include <vector>
+#include <string_view>
+#include <memory_resource>
 #include <filesystem>
 #include <functional>
 
 #include "../extern/sqlite3/sqlite3.h"
 
+#include "Structures/CancellationToken.h"
+#include "Structures/ParagraphMatch.h"
+#include "Structures/VocabularyHash.h"
+#include "Structures/VocabularySuffixArray.h"
+#include "Structures/VocabularyBlob.h"
+#include "Structures/SortedVocabulary.h"
+
 
 using namespace std;
 
@@ -44,17 +56,21 @@ public:
 
     sqlite3* sqlite3Interface() const { return db_mainThread; }
 
-    bool ExplainWordsTableQueryPlan(const string& normalized_word, const TextQueryType Type);
+    bool ExplainWordsTableQueryPlan(const string_view normalized_word, const TextQueryType Type);
 
-    vector<int64_t> QueryWordsTableReturnIds(const string& normalized_word, const TextQueryType Type);
+    vector<int64_t> QueryWordsTableReturnIds(const string_view normalized_word, const TextQueryType Type);
 
     /*
-    * get<0>(vector[i]) = paragraph id (unique - each paragraph will only occur once)
-    * get<1>(vector[i]) = paragraph original text
-    * get<2>(vector[i]) = the matched word id
-    * get<3>(vector[i]) = a vector containing all of the word ids in the paragraph, in the order that they occur in that paragraph
+    * One ParagraphMatch per paragraph that contains a matching word (each paragraph will only occur once).
+    *
+    * If Token is cancelled while the statement is running, sqlite aborts the statement and the results are empty.
     */
-    vector<tuple<int64_t, string, int64_t, vector<int64_t>>> GetAll_ParagraphId_ParagraphOriginalText_MatchedWordId_OrderedWordsInParagraphIds(const string& normalized_word, const TextQueryType Type, const bool UseBackgroundThread);
+    vector<ParagraphMatch> GetAll_ParagraphId_ParagraphOriginalText_MatchedWordId_OrderedWordsInParagraphIds(const string_view normalized_word, const TextQueryType Type, const bool UseBackgroundThread, const CancellationToken* Token = nullptr);
+
+    /*
+    * The same, for the words word_ids (other than normalized_word itself), eg. the words found by FindSimilarWords().
+    */
+    vector<ParagraphMatch> GetAll_ParagraphId_ParagraphOriginalText_MatchedWordId_OrderedWordsInParagraphIds(const string_view normalized_word, const vector<int64_t>& word_ids, const bool UseBackgroundThread, const CancellationToken* Token = nullptr);
 
     /*
     * get<0>(vector[i]) = paragraph id (unique - each paragraph will only occur once)
@@ -71,11 +87,75 @@ public:
 
     bool EndTransaction(const string TransactionName, const bool FailureUpsetsDatabaseValidity);
 
+    /*
+    * The LIKE pattern for Type, eg. "word%" for BEGINS_WITH. For EXACT_MATCH, the word itself.
+    * Allocated from Resource, eg. a buffer on the caller's stack.
+    */
+    static pmr::string LikePattern(const string_view normalized_word, const TextQueryType Type, pmr::memory_resource* Resource = pmr::get_default_resource());
+
+    /*
+    * The smallest string greater than every string that begins with prefix: prefix with its last byte incremented, after dropping any trailing 0xFF bytes.
+    * Returns false if there isn't one (prefix is empty or all 0xFF bytes, which never happens for UTF-8).
+    */
+    static bool PrefixSuccessor(const string_view prefix, pmr::string& successor);
+
+    /*
+    * Binds what Type matches to stmt's parameters, starting at first_index:
+    *   EXACT_MATCH     the word
+    *   CONTAINS        the LIKE pattern, "%word%"
+    *   BEGINS_WITH     the range [word, PrefixSuccessor(word)) of Words.word, as 2 parameters
+    *   ENDS_WITH       the range of Words.reversed_word that begin with the reversed word, as 2 parameters
+    * LIKE can't use an index (sqlite's LIKE is case insensitive, and the index isn't), but a range is a scan of idx_words or idx_words_reversed.
+    * pattern and upper_bound hold the bound strings, which are bound with SQLITE_STATIC, so they must outlive the statement.
+    */
+    static int BindWordPattern(sqlite3_stmt* stmt, const int first_index, const string_view normalized_word, const TextQueryType Type, pmr::string& pattern, pmr::string& upper_bound);
+
+    /*
+    * Corpus statistics for BM25, read once when the database is opened (after the test data is loaded).
+    */
+    static int64_t ParagraphCount() { return paragraph_count; }
+    static double AverageParagraphWordCount() { return average_paragraph_word_count; }
+
+    /*
+    * False if the word is definitely not in the Words table, so that an exact match query can be skipped. Doesn't touch sqlite.
+    * True if it is, or (once in 2^32 words, or if the vocabulary couldn't be hashed) might be.
+    */
+    static bool MayContainWord(const string_view normalized_word) { return !vocabulary.isValid() || vocabulary.Find(normalized_word) >= 0; }
+
+    /*
+    * The ids of the words within max_distance edits of the word (see LevenshteinAutomaton), with their distances, in increasing order of id.
+    * Leaves out the word itself and the words that contain it, which are its exact and partial matches. Doesn't touch sqlite.
+    */
+    static void FindSimilarWords(const string_view normalized_word, const uint8_t max_distance, vector<pair<int64_t, uint8_t>>& similar_words);
+
 protected:
     static char* errMsg;
     static Database* Instance;
     static sqlite3* db_mainThread;
     static sqlite3* db_backgroundThread;
     static bool bIsValid;
+    static int64_t paragraph_count;
+    static double average_paragraph_word_count;
+    static VocabularyHash vocabulary;   // built when the database is opened (after the test data is loaded). Words are only added while loading data
+    static VocabularySuffixArray vocabulary_suffixes;   // built with vocabulary. If it's empty, CONTAINS and ENDS_WITH are matched by sql
+    static VocabularyBlob vocabulary_blob;              // built with vocabulary. Only scanned with DATABASE_CONTAINS_SCAN or DATABASE_BENCHMARK_CONTAINS
+    static SortedVocabulary vocabulary_sorted;          // built with vocabulary, for FindSimilarWords()
+
+    bool LoadParagraphStatistics();
+
+    bool LoadVocabulary();
+
+    /*
+    * Steps stmt (a DML_SELECT_COMPOUND_1 statement) to the end, and collects its rows. rc is the last result of sqlite3_step().
+    */
+    static vector<ParagraphMatch> ReadParagraphMatches(sqlite3* db, sqlite3_stmt* stmt, const CancellationToken* Token, int& rc);
+
+#ifdef DATABASE_BENCHMARK_CONTAINS
+    /*
+    * Finds the words that contain the word with the LIKE query, the suffix array and the vocabulary scan, and logs how long each took,
+    * and whether they found the same words.
+    */
+    static void BenchmarkContains(sqlite3* db, const string_view normalized_word);
+#endif
 };
 
@@ -2,18 +2,51 @@
 
 #include "linux_threadpool.h"
 
-vector<pthread_t> ThreadPool::workers = {};
-queue<function<void()>> ThreadPool::tasks = queue<function<void()>>();
-pthread_mutex_t ThreadPool::queue_mutex;
-pthread_cond_t ThreadPool::condition;
-bool ThreadPool::stop = false;
-pthread_attr_t ThreadPool::attr;
-sched_param ThreadPool::param;
-
-ThreadPool::ThreadPool(size_t nThreads, int priority)
+ThreadPool::ThreadPool(size_t nThreads, int priority) : ThreadPool(nThreads, priority, {0, 0, 0}) {}
+
+ThreadPool::ThreadPool(size_t nThreads, int priority, const array<size_t, TASK_PRIORITY_COUNT>& nReservedThreads) : max_queue_depth{}, tasks_queued{}, stop{false}, has_reserved_workers{false}
 {
     int rc;
-    workers.reserve(nThreads);
+
+    size_t nReservedThreadsTotal = 0;
+    for (const size_t nReserved : nReservedThreads)
+    {
+        nReservedThreadsTotal += nReserved;
+    }
+
+    if (nReservedThreadsTotal > nThreads)
+    {
+        cerr << "ThreadPool::ThreadPool() - ERROR: Reserved more threads (" << nReservedThreadsTotal << ") than the thread pool has (" << nThreads << ")." << endl;
+        exit(EXIT_FAILURE);
+    }
+
+    /*
+    * Workers [0, nReservedThreads[0]) only run interactive tasks, the next nReservedThreads[1] workers run interactive and normal tasks, etc..
+    * Every worker after the reserved ones runs tasks of any priority class.
+    * 
+    * Note: the contexts must not be reallocated after the threads are created, because each thread holds a pointer to its context.
+    */
+    workers.resize(nThreads);
+    worker_counters = make_unique<WorkerCounters[]>(nThreads);
+    worker_contexts.reserve(nThreads);
+    for (size_t w = 0; w < nThreads; ++w)
+    {
+        worker_contexts.push_back(Worker{this, PRIORITY_BACKGROUND, &worker_counters[w]});
+    }
+
+    size_t i = 0;
+    for (size_t c = 0; c < TASK_PRIORITY_COUNT; ++c)
+    {
+        for (size_t j = 0; j < nReservedThreads[c]; ++j, ++i)
+        {
+            worker_contexts[i].lowest_priority = static_cast<TaskPriority>(c);
+
+            if (c != PRIORITY_BACKGROUND)
+            {
+                has_reserved_workers = true;
+            }
+        }
+    }
 
     rc = pthread_mutex_init(&queue_mutex, nullptr);
     if (rc != 0)
@@ -66,7 +99,7 @@ ThreadPool::ThreadPool(size_t nThreads, int priority)
 
     for(size_t i = 0; i < nThreads; ++i)
     {
-        rc = pthread_create(&workers[i], &attr, &ThreadPool::LoopThread, nullptr);
+        rc = pthread_create(&workers[i], &attr, &ThreadPool::LoopThread, &worker_contexts[i]);
         if (rc != 0)
         {
             cerr << "ThreadPool::ThreadPool() - ERROR: Error creating thread." << endl;
@@ -99,31 +132,249 @@ void ThreadPool::StopThreads()
 
 void* ThreadPool::LoopThread(void* args) 
 {
+    Worker* worker = static_cast<Worker*>(args);
+    ThreadPool* pool = worker->pool;
+
+    /*
+    * Returns the highest priority, non-empty queue that this worker is allowed to run tasks from, or nullptr.
+    * Must be called while holding the queue mutex.
+    */
+    auto NextQueue = [worker, pool]() -> queue<QueuedTask>*
+    {
+        for (size_t c = 0; c <= worker->lowest_priority; ++c)
+        {
+            if (!pool->tasks[c].empty())
+            {
+                return &pool->tasks[c];
+            }
+        }
+        return nullptr;
+    };
+
+#ifdef LINUX_THREADPOOL_TELEMETRY
+    WorkerCounters& counters = *worker->counters;
+
+    auto Add = [](atomic<uint64_t>& counter, const uint64_t value)
+    {
+        counter.store(counter.load(memory_order_relaxed) + value, memory_order_relaxed);
+    };
+
+    auto ElapsedNs = [](const chrono::steady_clock::time_point& from, const chrono::steady_clock::time_point& to) -> uint64_t
+    {
+        return static_cast<uint64_t>(chrono::duration_cast<chrono::nanoseconds>(to - from).count());
+    };
+#endif
+
     while(true)
     {
-        function<void()> task; // create a blank task
+        QueuedTask task; // create a blank task
+#ifdef LINUX_THREADPOOL_TELEMETRY
+        size_t task_priority;
+        chrono::steady_clock::time_point t_idle = chrono::steady_clock::now();
+#endif
         {
-            pthread_mutex_lock(&queue_mutex);
+            pthread_mutex_lock(&pool->queue_mutex);
 
-            while (tasks.empty() && !stop) 
+            queue<QueuedTask>* next = NextQueue();
+
+            while (next == nullptr && !pool->stop) 
             {
-                pthread_cond_wait(&condition, &queue_mutex); 
+                pthread_cond_wait(&pool->condition, &pool->queue_mutex); 
+                next = NextQueue();
             }
 
-            if (stop && tasks.empty()) 
+            if (pool->stop && next == nullptr) 
             {
-                pthread_mutex_unlock(&queue_mutex);
+                pthread_mutex_unlock(&pool->queue_mutex);
                 pthread_exit(nullptr);
                 return nullptr;
             }
 
-            task = move(tasks.front()); // populate the blank task with a real task from the queue
-            tasks.pop(); // remove the task from the queue
+            task = move(next->front()); // populate the blank task with a real task from the queue
+            next->pop(); // remove the task from the queue
+
+#ifdef LINUX_THREADPOOL_TELEMETRY
+            task_priority = static_cast<size_t>(next - &pool->tasks[0]);
 
-            pthread_mutex_unlock(&queue_mutex);
+            for (size_t c = task_priority + 1; c < TASK_PRIORITY_COUNT; ++c)
+            {
+                if (!pool->tasks[c].empty())
+                {
+                    Add(counters.priority_bypasses, 1);
+                    break;
+                }
+            }
+#endif
+            pthread_mutex_unlock(&pool->queue_mutex);
         }
 
-        task(); // execute the task
+#ifdef LINUX_THREADPOOL_TELEMETRY
+        const chrono::steady_clock::time_point t_start = chrono::steady_clock::now();
+        Add(counters.idle_ns, ElapsedNs(t_idle, t_start));
+        counters.queue_wait[task_priority].Record(ElapsedNs(task.queued_at, t_start));
+
+        task.run(); // execute the task
+
+        const uint64_t execution_ns = ElapsedNs(t_start, chrono::steady_clock::now());
+        Add(counters.busy_ns, execution_ns);
+        Add(counters.tasks_run[task_priority], 1);
+        counters.execution.Record(execution_ns);
+#else
+        task.run(); // execute the task
+#endif
     }
     return nullptr;
 }
+
+ThreadPoolTelemetry ThreadPool::Sample()
+{
+    ThreadPoolTelemetry telemetry;
+
+#ifdef LINUX_THREADPOOL_TELEMETRY
+    pthread_mutex_lock(&queue_mutex);
+    for (size_t c = 0; c < TASK_PRIORITY_COUNT; ++c)
+    {
+        telemetry.queue_depth[c] = tasks[c].size();
+        telemetry.max_queue_depth[c] = max_queue_depth[c];
+        telemetry.tasks_queued[c] = tasks_queued[c];
+    }
+    pthread_mutex_unlock(&queue_mutex);
+
+    telemetry.workers.resize(workers.size());
+    for (size_t w = 0; w < workers.size(); ++w)
+    {
+        const WorkerCounters& counters = worker_counters[w];
+        WorkerTelemetry& worker = telemetry.workers[w];
+
+        for (size_t c = 0; c < TASK_PRIORITY_COUNT; ++c)
+        {
+            worker.tasks_run[c] = counters.tasks_run[c].load(memory_order_relaxed);
+            worker.queue_wait[c] = counters.queue_wait[c].Load();
+        }
+        worker.priority_bypasses = counters.priority_bypasses.load(memory_order_relaxed);
+        worker.busy_ns = counters.busy_ns.load(memory_order_relaxed);
+        worker.idle_ns = counters.idle_ns.load(memory_order_relaxed);
+        worker.execution = counters.execution.Load();
+    }
+#endif
+
+    return telemetry;
+}
+
+void ThreadPool::ResetTelemetry()
+{
+#ifdef LINUX_THREADPOOL_TELEMETRY
+    pthread_mutex_lock(&queue_mutex);
+    for (size_t c = 0; c < TASK_PRIORITY_COUNT; ++c)
+    {
+        max_queue_depth[c] = tasks[c].size();
+        tasks_queued[c] = 0;
+    }
+    pthread_mutex_unlock(&queue_mutex);
+
+    /*
+    * Note: a worker that is in the middle of recording may overwrite part of the reset with its old value.
+    */
+    for (size_t w = 0; w < workers.size(); ++w)
+    {
+        WorkerCounters& counters = worker_counters[w];
+
+        for (size_t c = 0; c < TASK_PRIORITY_COUNT; ++c)
+        {
+            counters.tasks_run[c].store(0, memory_order_relaxed);
+            counters.queue_wait[c].Reset();
+        }
+        counters.priority_bypasses.store(0, memory_order_relaxed);
+        counters.busy_ns.store(0, memory_order_relaxed);
+        counters.idle_ns.store(0, memory_order_relaxed);
+        counters.execution.Reset();
+    }
+#endif
+}
+
+LatencyHistogram ThreadPool::AtomicHistogram::Load() const
+{
+    LatencyHistogram histogram;
+    for (size_t b = 0; b < LATENCY_HISTOGRAM_BUCKETS; ++b)
+    {
+        histogram.buckets[b] = buckets[b].load(memory_order_relaxed);
+    }
+    histogram.count = count.load(memory_order_relaxed);
+    histogram.total_ns = total_ns.load(memory_order_relaxed);
+    histogram.max_ns = max_ns.load(memory_order_relaxed);
+    return histogram;
+}
+
+void ThreadPool::AtomicHistogram::Reset()
+{
+    for (atomic<uint64_t>& bucket : buckets)
+    {
+        bucket.store(0, memory_order_relaxed);
+    }
+    count.store(0, memory_order_relaxed);
+    total_ns.store(0, memory_order_relaxed);
+    max_ns.store(0, memory_order_relaxed);
+}
+
+size_t LatencyHistogram::Bucket(const uint64_t ns)
+{
+    if (ns == 0)
+    {
+        return 0;
+    }
+
+    const size_t bucket = static_cast<size_t>(64 - __builtin_clzll(ns)); // ns is in [2^(bucket-1), 2^bucket)
+    return bucket < LATENCY_HISTOGRAM_BUCKETS ? bucket : LATENCY_HISTOGRAM_BUCKETS - 1;
+}
+
+uint64_t LatencyHistogram::Percentile(const double p) const
+{
+    if (count == 0)
+    {
+        return 0;
+    }
+
+    const uint64_t target = static_cast<uint64_t>(p * static_cast<double>(count));
+    uint64_t seen = 0;
+
+    for (size_t b = 0; b < LATENCY_HISTOGRAM_BUCKETS; ++b)
+    {
+        seen += buckets[b];
+        if (seen > target || seen == count)
+        {
+            return b == 0 ? 0 : min(max_ns, static_cast<uint64_t>(1) << b);
+        }
+    }
+    return max_ns;
+}
+
+void LatencyHistogram::Merge(const LatencyHistogram& other)
+{
+    for (size_t b = 0; b < LATENCY_HISTOGRAM_BUCKETS; ++b)
+    {
+        buckets[b] += other.buckets[b];
+    }
+    count += other.count;
+    total_ns += other.total_ns;
+    max_ns = max(max_ns, other.max_ns);
+}
+
+LatencyHistogram ThreadPoolTelemetry::QueueWait(const TaskPriority Priority) const
+{
+    LatencyHistogram total;
+    for (const WorkerTelemetry& worker : workers)
+    {
+        total.Merge(worker.queue_wait[Priority]);
+    }
+    return total;
+}
+
+LatencyHistogram ThreadPoolTelemetry::Execution() const
+{
+    LatencyHistogram total;
+    for (const WorkerTelemetry& worker : workers)
+    {
+        total.Merge(worker.execution);
+    }
+    return total;
+}
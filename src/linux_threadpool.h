@@ -5,6 +5,9 @@
 
 // #include <thread>
 #include <pthread.h> // use pthread instead of thread on linux to enable setting thread priority.
+#include <array>
+#include <atomic>
+#include <chrono>
 #include <queue>
 #include <mutex>
 #include <condition_variable>
@@ -14,39 +17,179 @@
 
 #define POLICY SCHED_FIFO // Set a scheduling policy at compile time. (You can set this at runtime instead. I just chose to do it this way.)
 // #define LINUX_THREADPOOL_LOG_DEBUG
+#define LINUX_THREADPOOL_TELEMETRY // comment out this line to compile out the queue depth, wait time and run time counters
+#define TASK_PRIORITY_COUNT (static_cast<size_t>(3))
+#define LATENCY_HISTOGRAM_BUCKETS (static_cast<size_t>(40))
 
 using namespace std;
 
+/*
+* Tasks are dequeued in strict priority order: a worker always takes the oldest task of the highest priority class that it is allowed to run.
+* Lower priority classes only run when every higher priority queue is empty, so background work can never delay an interactive task
+* by more than the time it takes to finish the task that a worker is already running.
+*/
+typedef enum : uint8_t {
+    PRIORITY_INTERACTIVE = 0,   // eg. the per-keystroke queries in Search::getMatches()
+    PRIORITY_NORMAL = 1,
+    PRIORITY_BACKGROUND = 2     // eg. ingestion, prefetching, index maintenance
+} TaskPriority;
+
+/*
+* Log2 histogram of durations in nanoseconds.
+* buckets[0] counts durations of 0ns, and buckets[b] counts durations in [2^(b-1), 2^b) nanoseconds. The last bucket also counts everything longer.
+*/
+struct LatencyHistogram
+{
+    array<uint64_t, LATENCY_HISTOGRAM_BUCKETS> buckets = {};
+    uint64_t count = 0;
+    uint64_t total_ns = 0;
+    uint64_t max_ns = 0;
+
+    static size_t Bucket(const uint64_t ns);
+
+    /*
+    * Returns the upper bound (in nanoseconds, capped at max_ns) of the bucket that contains the p-th percentile, where 0.0 <= p <= 1.0.
+    */
+    uint64_t Percentile(const double p) const;
+
+    uint64_t Mean() const { return count == 0 ? 0 : total_ns / count; }
+
+    void Merge(const LatencyHistogram& other);
+};
+
+struct WorkerTelemetry
+{
+    array<uint64_t, TASK_PRIORITY_COUNT> tasks_run = {};
+    uint64_t priority_bypasses = 0;                              // tasks this worker took while a lower priority task was also waiting. (There is no work stealing: all workers share one queue per priority class.)
+    uint64_t busy_ns = 0;
+    uint64_t idle_ns = 0;
+    array<LatencyHistogram, TASK_PRIORITY_COUNT> queue_wait;    // time between Do() and the start of execution, per priority class
+    LatencyHistogram execution;
+
+    double Utilization() const { return (busy_ns + idle_ns) == 0 ? 0.0 : static_cast<double>(busy_ns) / static_cast<double>(busy_ns + idle_ns); }
+};
+
+/*
+* A snapshot of the thread pool's counters, taken by ThreadPool::Sample().
+* Counters accumulate from the construction of the pool, or from the last call to ThreadPool::ResetTelemetry().
+*/
+struct ThreadPoolTelemetry
+{
+    array<size_t, TASK_PRIORITY_COUNT> queue_depth = {};         // at the time of the sample
+    array<size_t, TASK_PRIORITY_COUNT> max_queue_depth = {};
+    array<uint64_t, TASK_PRIORITY_COUNT> tasks_queued = {};
+    vector<WorkerTelemetry> workers;
+
+    /*
+    * Totals over all workers.
+    */
+    LatencyHistogram QueueWait(const TaskPriority Priority) const;
+    LatencyHistogram Execution() const;
+};
+
 class ThreadPool {
 public:
     ThreadPool(size_t nThreads, int priority);
 
+    /*
+    * nReservedThreads[c] of the nThreads workers are reserved for priority class c, and will only run tasks of class c or higher.
+    * eg. {1, 0, 0} keeps one worker free for interactive tasks no matter how much background work is queued.
+    * The remaining (unreserved) workers run tasks of any class.
+    */
+    ThreadPool(size_t nThreads, int priority, const array<size_t, TASK_PRIORITY_COUNT>& nReservedThreads);
+
+    /*
+    * Queues a task with PRIORITY_NORMAL.
+    */
     template<class F, class... Args>
     inline auto Do(F&& f, Args&&... args) -> future<typename result_of<F(Args...)>::type>;
 
+    template<class F, class... Args>
+    inline auto Do(const TaskPriority Priority, F&& f, Args&&... args) -> future<typename result_of<F(Args...)>::type>;
+
     ~ThreadPool();
 
     void StopThreads();
 
+    /*
+    * Safe to call from any thread, at any time. 
+    * Empty (all zeros) if LINUX_THREADPOOL_TELEMETRY is not defined.
+    */
+    ThreadPoolTelemetry Sample();
+
+    void ResetTelemetry();
+
 protected:
-    static vector<pthread_t> workers;
-    static queue<function<void()>> tasks;
-    static pthread_mutex_t queue_mutex;
-    static pthread_cond_t condition;
-    static bool stop;
+    /*
+    * Each worker is the only writer of its own counters, so they are updated with relaxed loads and stores (no locked instructions).
+    * Readers (Sample()) may see a slightly stale value, which is fine for telemetry.
+    */
+    struct AtomicHistogram
+    {
+        array<atomic<uint64_t>, LATENCY_HISTOGRAM_BUCKETS> buckets = {};
+        atomic<uint64_t> count = 0;
+        atomic<uint64_t> total_ns = 0;
+        atomic<uint64_t> max_ns = 0;
+
+        inline void Record(const uint64_t ns);
+        LatencyHistogram Load() const;
+        void Reset();
+    };
+
+    struct WorkerCounters
+    {
+        array<atomic<uint64_t>, TASK_PRIORITY_COUNT> tasks_run = {};
+        atomic<uint64_t> priority_bypasses = 0;
+        atomic<uint64_t> busy_ns = 0;
+        atomic<uint64_t> idle_ns = 0;
+        array<AtomicHistogram, TASK_PRIORITY_COUNT> queue_wait;
+        AtomicHistogram execution;
+    };
+
+    struct Worker
+    {
+        ThreadPool* pool;
+        TaskPriority lowest_priority; // the lowest priority class that this worker is allowed to run
+        WorkerCounters* counters;
+    };
+
+    struct QueuedTask
+    {
+        function<void()> run;
+#ifdef LINUX_THREADPOOL_TELEMETRY
+        chrono::steady_clock::time_point queued_at;
+#endif
+    };
+
+    vector<pthread_t> workers;
+    vector<Worker> worker_contexts;
+    unique_ptr<WorkerCounters[]> worker_counters; // atomics can't live in a vector
+    array<queue<QueuedTask>, TASK_PRIORITY_COUNT> tasks;
+    array<size_t, TASK_PRIORITY_COUNT> max_queue_depth;   // guarded by queue_mutex
+    array<uint64_t, TASK_PRIORITY_COUNT> tasks_queued;    // guarded by queue_mutex
+    pthread_mutex_t queue_mutex;
+    pthread_cond_t condition;
+    bool stop;
+    bool has_reserved_workers;
 
     static void* LoopThread(void* args);
-    static pthread_attr_t attr;
-    static sched_param param;
+    pthread_attr_t attr;
+    sched_param param;
 };
 
 template<class F, class... Args>
 inline auto ThreadPool::Do(F&& f, Args&&... args) -> future<typename result_of<F(Args...)>::type>
+{
+    return Do(PRIORITY_NORMAL, forward<F>(f), forward<Args>(args)...);
+}
+
+template<class F, class... Args>
+inline auto ThreadPool::Do(const TaskPriority Priority, F&& f, Args&&... args) -> future<typename result_of<F(Args...)>::type>
 {
     using return_type = typename result_of<F(Args...)>::type;
 
     auto task = make_shared<packaged_task<return_type()>>(bind(forward<F>(f), forward<Args>(args)...));
-        
+
     future<return_type> res = task->get_future();
     {
         pthread_mutex_lock(&queue_mutex);
@@ -57,9 +200,38 @@ inline auto ThreadPool::Do(F&& f, Args&&... args) -> future<typename result_of<F
             exit(EXIT_FAILURE);
         }
 
-        tasks.emplace([task](){ (*task)(); }); // add a task to the queue
+#ifdef LINUX_THREADPOOL_TELEMETRY
+        tasks[Priority].push(QueuedTask{[task](){ (*task)(); }, chrono::steady_clock::now()}); // add a task to the queue for its priority class
+
+        ++tasks_queued[Priority];
+        if (tasks[Priority].size() > max_queue_depth[Priority])
+        {
+            max_queue_depth[Priority] = tasks[Priority].size();
+        }
+#else
+        tasks[Priority].push(QueuedTask{[task](){ (*task)(); }}); // add a task to the queue for its priority class
+#endif
+    }
+    pthread_mutex_unlock(&queue_mutex); // unlock the mutex, which 'wakes up' all sleeping threads, but traps them inside the 'while (next == nullptr && !pool->stop)' loop in LoopThread() (which calls NextQueue()) until the mutex is locked again.
+
+    if (has_reserved_workers)
+    {
+        pthread_cond_broadcast(&condition); // a single signal could wake a reserved worker that isn't allowed to run this task, so wake ALL workers and let the ones that can run it compete for it.
+    } else
+    {
+        pthread_cond_signal(&condition); // signal ONE worker, which continues the execution loop in ThreadPool::LoopThread() from the line 'pthread_cond_wait(&condition, &queue_mutex) due to tasks no longer being empty.
     }
-    pthread_mutex_unlock(&queue_mutex); // unlock the mutex, which 'wakes up' all sleeping threads, but traps them inside the 'while (tasks.empty() && !stop)' loop until the mutex is locked again.
-    pthread_cond_signal(&condition); // signal ONE worker, which continues the execution loop in ThreadPool::startThread() from the line 'pthread_cond_wait(&condition, &queue_mutex) due to tasks no longer being empty.
     return res;
 }
+
+inline void ThreadPool::AtomicHistogram::Record(const uint64_t ns)
+{
+    atomic<uint64_t>& bucket = buckets[LatencyHistogram::Bucket(ns)];
+    bucket.store(bucket.load(memory_order_relaxed) + 1, memory_order_relaxed);
+    count.store(count.load(memory_order_relaxed) + 1, memory_order_relaxed);
+    total_ns.store(total_ns.load(memory_order_relaxed) + ns, memory_order_relaxed);
+    if (ns > max_ns.load(memory_order_relaxed))
+    {
+        max_ns.store(ns, memory_order_relaxed);
+    }
+}
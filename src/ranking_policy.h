@@ -0,0 +1,129 @@
+#pragma once
+
+#define SEARCH_BM25_K1 1.2                          // BM25 term frequency saturation
+#define SEARCH_BM25_B 0.75                          // BM25 paragraph length normalization, from 0.0 (none) to 1.0 (full)
+#define SEARCH_BM25_PARTIAL_MATCH_WEIGHT 0.5        // a partially matched word (eg. "summit" for "summ") scores this fraction of an exactly matched word
+#define SEARCH_BM25_FUZZY_MATCH_WEIGHT 0.4          // a fuzzily matched word (eg. "summit" for "sumit") scores this fraction of an exactly matched word per edit: 0.4 for 1 edit, 0.16 for 2
+#define SEARCH_PROXIMITY_WEIGHT 1.0                 // added to a paragraph's score for each pair of consecutive query words that are also next to each other in the paragraph
+
+#include <cmath>
+#include <cstdint>
+#include <string>
+#include <vector>
+#include <utility>
+
+#include "Structures/ParagraphMatch.h"
+
+using namespace std;
+
+/*
+* Ranking policies are selected at compile time with SEARCH_RANKING_POLICY (see search.h), so that the scoring loops in search.cpp
+* are compiled for one policy, and the policy's functions are inlined into them. There is no virtual call per paragraph or per comparison.
+*
+* A policy is a struct with:
+*   typedef ... Score;                   an arithmetic type. Higher is better, and a paragraph's score is the sum of what it gets from each match,
+*                                        which is what lets top-K ranking bound the score of a paragraph that it hasn't seen yet (see Search::calculateParagraphScores())
+*   static Score ExactMatch(match, corpus)     what a paragraph gets for containing a query word
+*   static Score PartialMatch(match, corpus)   what a paragraph gets for containing a word that contains a query word (eg. "summit" for "summ")
+*   static Score FuzzyMatch(match, distance, corpus)   what a paragraph gets for containing a word that's distance edits away from a query word (eg. "summit" for "sumit")
+*   static Score Proximity(adjacent_words)     what a paragraph gets for pairs of consecutive query words that are next to each other in it. Must not decrease as adjacent_words grows
+*   static bool TieBreak(a, b)                 true if a ranks before b, when their scores are equal
+*/
+
+/*
+* Corpus statistics, read once per query.
+*/
+struct CorpusStatistics
+{
+    double paragraph_count;
+    double average_paragraph_word_count;
+};
+
+/*
+* What Search::calculateParagraphScores() accumulates for one paragraph.
+*/
+template<class Policy>
+struct ParagraphScore
+{
+    typename Policy::Score score = 0;
+    int exact_matches = 0;
+    int partial_matches = 0;
+    int fuzzy_matches = 0;
+    int adjacent_words = 0;                     // pairs of consecutive query words that are next to each other in the paragraph
+    const ParagraphMatch* match = nullptr;      // the paragraph's text, document and words. Points into the WordMatch that the paragraph was first found in, so nothing is copied per match
+};
+
+/*
+* BM25, using the document frequency of the matched word and the word count of the paragraph, which are stored at ingest time.
+*/
+struct BM25RankingPolicy
+{
+    typedef double Score;
+
+    static inline Score BM25(const ParagraphMatch& match, const CorpusStatistics& corpus)
+    {
+        const double document_frequency = static_cast<double>(match.matched_word_document_frequency);
+        const double term_frequency = static_cast<double>(match.MatchedWordFrequency());
+
+        const double idf = log(1.0 + (corpus.paragraph_count - document_frequency + 0.5) / (document_frequency + 0.5));
+        const double length_norm = SEARCH_BM25_K1 * (1.0 - SEARCH_BM25_B + SEARCH_BM25_B * static_cast<double>(match.word_count) / corpus.average_paragraph_word_count);
+
+        return idf * term_frequency * (SEARCH_BM25_K1 + 1.0) / (term_frequency + length_norm);
+    }
+
+    static inline Score ExactMatch(const ParagraphMatch& match, const CorpusStatistics& corpus) { return BM25(match, corpus); }
+
+    static inline Score PartialMatch(const ParagraphMatch& match, const CorpusStatistics& corpus) { return SEARCH_BM25_PARTIAL_MATCH_WEIGHT * BM25(match, corpus); }
+
+    static inline Score FuzzyMatch(const ParagraphMatch& match, const uint8_t distance, const CorpusStatistics& corpus) { return pow(SEARCH_BM25_FUZZY_MATCH_WEIGHT, distance) * BM25(match, corpus); }
+
+    static inline Score Proximity(const int adjacent_words) { return SEARCH_PROXIMITY_WEIGHT * adjacent_words; }
+
+    /*
+    * More exact matches, then more partial matches, then more fuzzy matches, then the lowest paragraph id.
+    */
+    static inline bool TieBreak(const pair<int64_t, ParagraphScore<BM25RankingPolicy>>& a, const pair<int64_t, ParagraphScore<BM25RankingPolicy>>& b)
+    {
+        if (a.second.exact_matches != b.second.exact_matches)
+        {
+            return a.second.exact_matches > b.second.exact_matches;
+        }
+
+        if (a.second.partial_matches != b.second.partial_matches)
+        {
+            return a.second.partial_matches > b.second.partial_matches;
+        }
+
+        if (a.second.fuzzy_matches != b.second.fuzzy_matches)
+        {
+            return a.second.fuzzy_matches > b.second.fuzzy_matches;
+        }
+
+        return a.first < b.first;
+    }
+};
+
+/*
+* The number of exactly matched query words, then the number of partially (or fuzzily) matched query words. Ignores word frequencies, lengths, typos and proximity.
+* An exact match outweighs any number of partial matches, so this ranks like comparing (exact matches, partial matches) pairs.
+*/
+struct MatchCountRankingPolicy
+{
+    typedef int64_t Score;
+
+    static inline Score ExactMatch(const ParagraphMatch&, const CorpusStatistics&) { return static_cast<Score>(1) << 32; }
+
+    static inline Score PartialMatch(const ParagraphMatch&, const CorpusStatistics&) { return 1; }
+
+    static inline Score FuzzyMatch(const ParagraphMatch&, const uint8_t, const CorpusStatistics&) { return 1; }
+
+    static inline Score Proximity(const int) { return 0; }
+
+    /*
+    * The lowest paragraph id.
+    */
+    static inline bool TieBreak(const pair<int64_t, ParagraphScore<MatchCountRankingPolicy>>& a, const pair<int64_t, ParagraphScore<MatchCountRankingPolicy>>& b)
+    {
+        return a.first < b.first;
+    }
+};
@@ -1,6 +1,8 @@
 #include <iostream>
 #include <memory>
 #include <algorithm>
+#include <limits>
+#include <type_traits>
 
 #ifdef SEARCH_LOG_EXECUTION_TIMES
 #include <chrono>
@@ -14,14 +16,23 @@
 #include "DDL/table_paragraphs.h"
 #include "DDL/table_words_to_paragraphs.h"
 
+#include "Structures/UnicodeFolding.h"
+#include "Structures/SortedSetKernels.h"
+
 Search*           Search::Instance = nullptr;
 char              Search::SearchBarBuffer[MAX_PARAGRAPH_SIZE] = "";
 vector<WordMatch> Search::SearchProgress = {};
-vector<string>    Search::SearchResults = {};
+NormalizedText    Search::QueryText;
+vector<QueryPhrase> Search::QueryPhrases = {};
+DenseAccumulator<uint64_t> Search::QueryWordMasks;
+QueryArena        Search::Arena;
+TripleBuffer<vector<string>> Search::SearchResults;
 ThreadPool*       Search::Pool = nullptr;
+SearchExecutor*   Search::Executor = nullptr;
 
 Search::Search() {
     Pool = new ThreadPool(1, 99);
+    Executor = new SearchExecutor(Search::runQuery);
 }
 
 Search* Search::Get() 
@@ -36,6 +47,12 @@ Search* Search::Get()
 
 void Search::Destroy() 
 {
+    if (Executor)
+    {
+        delete Executor; // joins the executor thread, which may still be using the pool
+    }
+    Executor = nullptr;
+
     Pool->StopThreads();
 
     if (Pool)
@@ -51,143 +68,656 @@ void Search::Destroy()
     Instance = nullptr;
 }
 
-inline const WordMatch Search::getMatches(Database* db_prechecked, const string& normalized_word)
+inline const WordMatch Search::getMatches(Database* db_prechecked, const string_view normalized_word, const bool SkipPartialMatches, const bool SkipFuzzyMatches, const CancellationToken& Token)
 {
-    bool has_exact_matches;
-    int64_t exact_match_idx;
-    vector<tuple<int64_t, string, vector<int64_t>>> exact_match_data;
+    bool has_exact_matches = false;
+    int64_t exact_match_idx = -1;
+    vector<ParagraphMatch> exact_match_data;
     bool has_partial_matches;
     vector<int64_t> partial_match_idxs;
-    vector<tuple<int64_t, string, vector<int64_t>>> partial_match_data;
+    vector<ParagraphMatch> partial_match_data;
+    bool has_fuzzy_matches;
+    vector<int64_t> fuzzy_match_idxs;
+    vector<ParagraphMatch> fuzzy_match_data;
+    vector<uint8_t> fuzzy_match_distances;
+
+    double exact_match_max_score = 0.0;
+    double partial_match_max_score = 0.0;
+    double fuzzy_match_max_score = 0.0;
+
+    const CorpusStatistics corpus = corpusStatistics();
+
+    /*
+    * Most keystrokes end in a word that's still being typed, which usually isn't a word of the vocabulary yet (eg. "summ").
+    * The vocabulary hash answers that without sqlite, so the exact match query only runs for words that exist.
+    */
+    const bool may_have_exact_matches = Database::MayContainWord(normalized_word);
+
+    future<void> exact_matches_future;
+    if (may_have_exact_matches)
+    {
+        exact_matches_future = Pool->Do(PRIORITY_INTERACTIVE, [db_prechecked, normalized_word, &Token, &has_exact_matches, &exact_match_idx, &exact_match_data, &exact_match_max_score, corpus] {
+            exact_match_data = db_prechecked->GetAll_ParagraphId_ParagraphOriginalText_MatchedWordId_OrderedWordsInParagraphIds(normalized_word, TextQueryType::EXACT_MATCH, true, &Token);
+            has_exact_matches = !exact_match_data.empty();
 
-    future<void> exact_matches_future = Pool->Do([db_prechecked, normalized_word, &has_exact_matches, &exact_match_idx, &exact_match_data] {
-        const vector<tuple<int64_t, string, int64_t, vector<int64_t>>> exact_matches = db_prechecked->GetAll_ParagraphId_ParagraphOriginalText_MatchedWordId_OrderedWordsInParagraphIds(normalized_word, TextQueryType::EXACT_MATCH, true);
-        has_exact_matches = !exact_matches.empty();
+            if (has_exact_matches)
+            {
+                exact_match_idx = exact_match_data[0].matched_word_id;
+            }
 
-        if (has_exact_matches)
+            for (const ParagraphMatch& data : exact_match_data)
+            {
+                exact_match_max_score = max(exact_match_max_score, static_cast<double>(RankingPolicy::ExactMatch(data, corpus)));
+            }
+        });
+    }
+
+    /*
+    * A word that isn't in the vocabulary may be a typo, so the words an edit or two away from it are looked up too (eg. "summit" for "sumit").
+    * They're found by running a Levenshtein automaton down the sorted vocabulary, not by comparing the word with every word of the vocabulary,
+    * and looked up on the pool thread, which the exact match query isn't using.
+    * A paragraph's distance is that of the closest of its matched words.
+    *
+    * A word that's still being typed (SkipFuzzyMatches) is usually unfinished rather than a typo, so its fuzzy matches are only looked up
+    * once its partial matches are known, and only if there aren't any: if no word of the vocabulary contains it, typing more can't match anything either.
+    */
+    const uint8_t max_distance = (normalized_word.size() >= SEARCH_FUZZY_MIN_WORD_SIZE_2) ? 2 : (normalized_word.size() >= SEARCH_FUZZY_MIN_WORD_SIZE_1) ? 1 : 0;
+    const bool may_be_typo = !may_have_exact_matches && !SkipPartialMatches && max_distance > 0;
+    const bool may_have_fuzzy_matches = may_be_typo && !SkipFuzzyMatches;
+
+    auto findFuzzyMatches = [db_prechecked, normalized_word, max_distance, &Token, &fuzzy_match_data, &fuzzy_match_distances, &fuzzy_match_max_score, corpus] (const bool UseBackgroundThread) {
+        vector<pair<int64_t, uint8_t>> similar_words;
+        Database::FindSimilarWords(normalized_word, max_distance, similar_words);
+
+        vector<int64_t> similar_word_ids;
+        similar_word_ids.reserve(similar_words.size());
+        for (const pair<int64_t, uint8_t>& word : similar_words)
         {
-            exact_match_idx = get<2>(exact_matches[0]);
-            exact_match_data.reserve(exact_matches.size());
+            similar_word_ids.push_back(word.first);
+        }
 
-            for (const tuple<int64_t, string, int64_t, vector<int64_t>>& data : exact_matches)
+        fuzzy_match_data = db_prechecked->GetAll_ParagraphId_ParagraphOriginalText_MatchedWordId_OrderedWordsInParagraphIds(normalized_word, similar_word_ids, UseBackgroundThread, &Token);
+
+        fuzzy_match_distances.reserve(fuzzy_match_data.size());
+        for (const ParagraphMatch& data : fuzzy_match_data)
+        {
+            uint8_t distance = max_distance;
+            for (const int64_t word_id : data.matched_word_ids)
             {
-                exact_match_data.push_back(tuple(get<0>(data), get<1>(data), get<3>(data)));
+                distance = min(distance, lower_bound(similar_words.begin(), similar_words.end(), pair<int64_t, uint8_t>(word_id, 0))->second);
             }
+
+            fuzzy_match_distances.push_back(distance);
+            fuzzy_match_max_score = max(fuzzy_match_max_score, static_cast<double>(RankingPolicy::FuzzyMatch(data, distance, corpus)));
         }
-    });
+    };
 
-    const vector<tuple<int64_t, string, int64_t, vector<int64_t>>> partial_matches = (normalized_word.size() == 1) ?
-        db_prechecked->GetAll_ParagraphId_ParagraphOriginalText_MatchedWordId_OrderedWordsInParagraphIds(normalized_word, TextQueryType::BEGINS_WITH, false) :
-        db_prechecked->GetAll_ParagraphId_ParagraphOriginalText_MatchedWordId_OrderedWordsInParagraphIds(normalized_word, TextQueryType::CONTAINS, false);
-    has_partial_matches = !partial_matches.empty();
+    future<void> fuzzy_matches_future;
+    if (may_have_fuzzy_matches)
+    {
+        fuzzy_matches_future = Pool->Do(PRIORITY_INTERACTIVE, [&findFuzzyMatches] { findFuzzyMatches(true); });
+    }
 
-    if (has_partial_matches)
+    if (!SkipPartialMatches)
     {
-        partial_match_idxs.reserve(partial_matches.size());
-        partial_match_data.reserve(partial_matches.size());
+        partial_match_data = (normalized_word.size() == 1) ?
+            db_prechecked->GetAll_ParagraphId_ParagraphOriginalText_MatchedWordId_OrderedWordsInParagraphIds(normalized_word, TextQueryType::BEGINS_WITH, false, &Token) :
+            db_prechecked->GetAll_ParagraphId_ParagraphOriginalText_MatchedWordId_OrderedWordsInParagraphIds(normalized_word, TextQueryType::CONTAINS, false, &Token);
+    }
+    has_partial_matches = !partial_match_data.empty();
 
-        for (const tuple<int64_t, string, int64_t, vector<int64_t>>& data : partial_matches)
+    if (has_partial_matches)
+    {
+        for (const ParagraphMatch& data : partial_match_data)
         {
-            partial_match_idxs.push_back(get<2>(data));
-            partial_match_data.push_back(tuple(get<0>(data), get<1>(data), get<3>(data)));
+            partial_match_idxs.insert(partial_match_idxs.end(), data.matched_word_ids.begin(), data.matched_word_ids.end());
+            partial_match_max_score = max(partial_match_max_score, static_cast<double>(RankingPolicy::PartialMatch(data, corpus)));
         }
+        sort(partial_match_idxs.begin(), partial_match_idxs.end());
+        partial_match_idxs.erase(unique(partial_match_idxs.begin(), partial_match_idxs.end()), partial_match_idxs.end());
+    }
+
+    const bool fuzzy_matches_skipped = may_be_typo && SkipFuzzyMatches && has_partial_matches;
+    if (may_be_typo && SkipFuzzyMatches && !has_partial_matches && !Token.isCancelled())
+    {
+        findFuzzyMatches(false);
     }
     
-    exact_matches_future.get();
+    if (may_have_exact_matches)
+    {
+        exact_matches_future.get();
+    }
+
+    if (may_have_fuzzy_matches)
+    {
+        fuzzy_matches_future.get();
+    }
+    has_fuzzy_matches = !fuzzy_match_data.empty();
 
-    if (!has_exact_matches)
+    if (has_fuzzy_matches)
+    {
+        for (const ParagraphMatch& data : fuzzy_match_data)
+        {
+            fuzzy_match_idxs.insert(fuzzy_match_idxs.end(), data.matched_word_ids.begin(), data.matched_word_ids.end());
+        }
+        sort(fuzzy_match_idxs.begin(), fuzzy_match_idxs.end());
+        fuzzy_match_idxs.erase(unique(fuzzy_match_idxs.begin(), fuzzy_match_idxs.end()), fuzzy_match_idxs.end());
+    }
+
+    if (!has_exact_matches && !has_fuzzy_matches)
     {
         if (has_partial_matches)
         {
-            return WordMatch(normalized_word, partial_match_idxs, partial_match_data);
+            return WordMatch(normalized_word, partial_match_idxs, partial_match_data, partial_match_max_score, false, fuzzy_matches_skipped);
         } else
         {
-            return WordMatch(normalized_word, {}, {});
+            return WordMatch(normalized_word, {}, {}, 0.0, SkipPartialMatches, fuzzy_matches_skipped);
         }
     } else
     {
 
 #ifdef SEARCH_CHECK_FOR_ASSUMED_IMPOSSIBLE_ERRORS
-    int64_t idx = get<2>(exact_matches[0]);
-    for (const tuple<int64_t, string, int64_t, vector<int64_t>>& match : exact_matches)
+    for (const ParagraphMatch& match : exact_match_data)
     {
-        if (get<2>(match) != idx)
+        if (match.matched_word_id != exact_match_idx)
         {
             cerr << "searchBarInputCallback() - ERROR: Found more than 1 word in the words database that was an exact match to the input '" << normalized_word <<"'" << endl;
-            for (const tuple<int64_t, string, int64_t, vector<int64_t>>& match : exact_matches)
+            for (const ParagraphMatch& match : exact_match_data)
             {
-                cerr << "   Note: matched paragraph id: " << get<0>(match) << ", word id: " << get<2>(match) << endl;
+                cerr << "   Note: matched paragraph id: " << match.paragraph_id << ", word id: " << match.matched_word_id << endl;
             }
             exit(EXIT_FAILURE);
         }
     }
 #endif
-        return WordMatch(normalized_word, exact_match_idx, exact_match_data, partial_match_idxs, partial_match_data);
+        return WordMatch(normalized_word, exact_match_idx, exact_match_data, exact_match_max_score, partial_match_idxs, partial_match_data, partial_match_max_score, fuzzy_match_idxs, fuzzy_match_data, fuzzy_match_distances, fuzzy_match_max_score, SkipPartialMatches, fuzzy_matches_skipped);
+    }
+}
+
+inline CorpusStatistics Search::corpusStatistics()
+{
+    return CorpusStatistics{
+        static_cast<double>(Database::ParagraphCount()), 
+        Database::AverageParagraphWordCount() > 0.0 ? Database::AverageParagraphWordCount() : 1.0
+    };
+}
+
+inline uint64_t Search::scoreProximity(const vector<int64_t>& word_ids, const DenseAccumulator<uint64_t>& query_word_masks, const uint64_t phrase_starts, const uint64_t phrase_ends, int& adjacent_words)
+{
+    /*
+    * previous is the set of query words that the previous word of the paragraph matched. Query word j+1 right after query word j is bit (j+1) of (previous << 1).
+    *
+    * Phrases are matched like bitap (shift-and) string matching, with words instead of characters:
+    * bit j of chain is set if the phrase's words up to query word j end at the current word of the paragraph. A chain can only begin at the first word of a phrase.
+    */
+    uint64_t previous = 0;
+    uint64_t chain = 0;
+    uint64_t adjacent = 0;
+    uint64_t phrases_found = 0;
+
+    for (const int64_t word_id : word_ids)
+    {
+        const uint64_t current = query_word_masks.Get(word_id);
+
+        adjacent |= (previous << 1) & current;
+        chain = ((chain << 1) | phrase_starts) & current;
+        phrases_found |= chain & phrase_ends;
+
+        previous = current;
+    }
+
+    adjacent_words = __builtin_popcountll(adjacent);
+    return phrases_found;
+}
+
+inline void Search::buildQueryWordMasks(const vector<WordMatch>& matches, const vector<QueryPhrase>& phrases, DenseAccumulator<uint64_t>& query_word_masks, uint64_t& phrase_starts, uint64_t& phrase_ends)
+{
+    query_word_masks.Reset();
+
+    const size_t nQueryWords = min(matches.size(), SEARCH_PROXIMITY_MAX_QUERY_WORDS);
+
+    for (size_t j = 0; j < nQueryWords; ++j) {
+        const uint64_t bit = static_cast<uint64_t>(1) << j;
+
+        if (matches[j].foundExactMatch()) {
+            query_word_masks[matches[j].exact_match_idx] |= bit;
+        }
+        for (const int64_t partialMatchId : matches[j].partial_match_idxs) {
+            query_word_masks[partialMatchId] |= bit;
+        }
+        for (const int64_t fuzzyMatchId : matches[j].fuzzy_match_idxs) {
+            query_word_masks[fuzzyMatchId] |= bit;
+        }
+    }
+
+    phrase_starts = 0;
+    phrase_ends = 0;
+    for (const QueryPhrase& phrase : phrases) {
+        if (phrase.last_word <= nQueryWords) {
+            phrase_starts |= static_cast<uint64_t>(1) << phrase.first_word;
+            phrase_ends |= static_cast<uint64_t>(1) << (phrase.last_word - 1);
+        }
     }
 }
 
-inline unordered_map<int64_t, pair<pair<int, int>, string>> Search::calculateParagraphScores(const vector<WordMatch>& matches) {
-    unordered_map<int64_t, pair<pair<int, int>, string>> paragraphScores;
+inline bool Search::findPhraseParagraphs(const vector<WordMatch>& matches, const vector<QueryPhrase>& phrases, RoaringBitmap& phrase_paragraphs)
+{
+    vector<vector<uint32_t>> word_paragraphs;
+
+    for (const QueryPhrase& phrase : phrases) {
+        for (size_t j = phrase.first_word; j < phrase.last_word && j < matches.size(); ++j) {
+            word_paragraphs.push_back(matches[j].MatchedParagraphIds());
+        }
+    }
+
+    if (word_paragraphs.empty()) {
+        return false;
+    }
+
+    /*
+    * Intersected from the smallest set up, so that every intersection is at most as large as the smallest set, and a much broader word (eg. "s") is galloped through.
+    */
+    sort(word_paragraphs.begin(), word_paragraphs.end(), [](const vector<uint32_t>& a, const vector<uint32_t>& b) { return a.size() < b.size(); });
+
+    vector<uint32_t> candidates = std::move(word_paragraphs[0]);
+    vector<uint32_t> intersection;
+
+    for (size_t k = 1; k < word_paragraphs.size() && !candidates.empty(); ++k) {
+        intersection.resize(candidates.size());
+        intersection.resize(IntersectSorted(candidates.data(), candidates.size(), word_paragraphs[k].data(), word_paragraphs[k].size(), intersection.data()));
+        candidates.swap(intersection);
+    }
+
+    phrase_paragraphs = RoaringBitmap(candidates.data(), candidates.size());
+    return true;
+}
+
+#ifdef SEARCH_TOP_K
+template<class Policy>
+inline ParagraphScoreList<Policy> Search::calculateParagraphScores(const vector<WordMatch>& matches, const vector<QueryPhrase>& phrases, const CancellationToken& Token) {
+    typedef typename Policy::Score Score;
+
+    const CorpusStatistics corpus = corpusStatistics();
+
+    uint64_t phraseStarts = 0;
+    uint64_t phraseEnds = 0;
+    if (matches.size() >= 2) {
+        buildQueryWordMasks(matches, phrases, QueryWordMasks, phraseStarts, phraseEnds);
+    }
+
+    RoaringBitmap phraseParagraphs;
+    const bool hasPhrases = findPhraseParagraphs(matches, phrases, phraseParagraphs);
+
+    const Score proximityMaxScore = (matches.size() >= 2) ? Policy::Proximity(static_cast<int>(min(matches.size(), SEARCH_PROXIMITY_MAX_QUERY_WORDS) - 1)) : 0;
+
+    /*
+    * The lists are ordered by max score, so that lists [0, i] are the ones that the least can be gained from.
+    * maxScoreSums[i] is their total (slightly rounded up for floating point scores, since scores are added in a different order than the bounds are).
+    */
+    pmr::vector<PostingCursor<Policy>> lists(&Arena);
+    for (const auto& wordMatch : matches) {
+        if (!wordMatch.exact_match_data.empty()) {
+            lists.push_back(PostingCursor<Policy>{&wordMatch.exact_match_data, EXACT_WORD_MATCH, nullptr, static_cast<Score>(wordMatch.exact_match_max_score), PostingList::Cursor(wordMatch.exact_match_paragraph_ids)});
+        }
+        if (!wordMatch.partial_match_data.empty()) {
+            lists.push_back(PostingCursor<Policy>{&wordMatch.partial_match_data, PARTIAL_WORD_MATCH, nullptr, static_cast<Score>(wordMatch.partial_match_max_score), PostingList::Cursor(wordMatch.partial_match_paragraph_ids)});
+        }
+        if (!wordMatch.fuzzy_match_data.empty()) {
+            lists.push_back(PostingCursor<Policy>{&wordMatch.fuzzy_match_data, FUZZY_WORD_MATCH, &wordMatch.fuzzy_match_distances, static_cast<Score>(wordMatch.fuzzy_match_max_score), PostingList::Cursor(wordMatch.fuzzy_match_paragraph_ids)});
+        }
+    }
+    sort(lists.begin(), lists.end(), [](const PostingCursor<Policy>& a, const PostingCursor<Policy>& b) { return a.max_score < b.max_score; });
+
+    pmr::vector<Score> maxScoreSums(lists.size(), &Arena);
+    Score maxScoreSum = proximityMaxScore;
+    for (size_t i = 0; i < lists.size(); ++i) {
+        maxScoreSum += lists[i].max_score;
+        maxScoreSums[i] = is_floating_point<Score>::value ? static_cast<Score>(maxScoreSum * (1.0 + 1e-9)) : maxScoreSum;
+    }
+
+    /*
+    * topParagraphs is a heap with the worst result at the front. Once it's full, the worst result's score is the threshold that a paragraph has to reach.
+    * Lists [0, firstEssential) are the non-essential lists, whose max scores add up to less than the threshold.
+    */
+    ParagraphScoreList<Policy> topParagraphs(&Arena);
+    topParagraphs.reserve(SEARCH_TOP_K);
+#ifdef SEARCH_GROUP_RESULTS_BY_DOCUMENT
+    pmr::unordered_map<int64_t, int64_t> topDocuments(&Arena); // document id -> the paragraph id of its entry in topParagraphs
+#endif
+    Score threshold = numeric_limits<Score>::lowest();
+    size_t firstEssential = 0;
+    size_t nCandidates = 0;
+
+    while (true) {
+        int64_t candidate = INT64_MAX;
+        for (size_t i = firstEssential; i < lists.size(); ++i) {
+            if (!lists[i].position.AtEnd()) {
+                candidate = min(candidate, static_cast<int64_t>(lists[i].position.Value()));
+            }
+        }
+
+        if (candidate == INT64_MAX) {
+            break;
+        }
+
+        if (++nCandidates % SEARCH_TOP_K_CANCELLATION_CHECK_INTERVAL == 0 && Token.isCancelled()) {
+            return {};
+        }
+
+        if (hasPhrases && !phraseParagraphs.Contains(static_cast<uint32_t>(candidate))) {
+            for (size_t i = firstEssential; i < lists.size(); ++i) {
+                if (!lists[i].position.AtEnd() && lists[i].position.Value() == candidate) {
+                    lists[i].position.Next();
+                }
+            }
+            continue;
+        }
+
+        ParagraphScore<Policy> score;
+        const ParagraphMatch* candidateMatch = nullptr;
+
+        auto AddPosting = [&](const PostingCursor<Policy>& list, const size_t index) {
+            const ParagraphMatch& match = (*list.postings)[index];
+
+            switch (list.match_class) {
+                case EXACT_WORD_MATCH: {
+                    score.score += Policy::ExactMatch(match, corpus);
+                    score.exact_matches++;
+                    break;
+                }
+                case PARTIAL_WORD_MATCH: {
+                    score.score += Policy::PartialMatch(match, corpus);
+                    score.partial_matches++;
+                    break;
+                }
+                case FUZZY_WORD_MATCH: {
+                    score.score += Policy::FuzzyMatch(match, (*list.distances)[index], corpus);
+                    score.fuzzy_matches++;
+                    break;
+                }
+            }
+            candidateMatch = &match;
+        };
+
+        for (size_t i = firstEssential; i < lists.size(); ++i) {
+            PostingCursor<Policy>& list = lists[i];
+            if (!list.position.AtEnd() && list.position.Value() == candidate) {
+                AddPosting(list, list.position.Index());
+                list.position.Next();
+            }
+        }
+
+        /*
+        * The non-essential lists are probed from the most to the least valuable, until the candidate can't reach the threshold anymore.
+        */
+        bool pruned = false;
+        for (size_t i = firstEssential; i-- > 0;) {
+            if (score.score + maxScoreSums[i] < threshold) {
+                pruned = true;
+                break;
+            }
+
+            PostingCursor<Policy>& list = lists[i];
+            list.position.SkipTo(static_cast<uint32_t>(candidate));
+
+            if (!list.position.AtEnd() && list.position.Value() == candidate) {
+                AddPosting(list, list.position.Index());
+                list.position.Next();
+            }
+        }
+
+        if (pruned || score.score + proximityMaxScore < threshold) {
+            continue;
+        }
+
+        if (matches.size() >= 2) {
+            const uint64_t phrasesFound = scoreProximity(candidateMatch->word_ids, QueryWordMasks, phraseStarts, phraseEnds, score.adjacent_words);
+
+            if (phrasesFound != phraseEnds) {
+                continue;
+            }
+            score.score += Policy::Proximity(score.adjacent_words);
+        }
+        score.match = candidateMatch;
+
+        pair<int64_t, ParagraphScore<Policy>> entry = {candidate, std::move(score)};
+
+        if (topParagraphs.size() == SEARCH_TOP_K && !rankParagraphs<Policy>(entry, topParagraphs.front())) {
+            continue;
+        }
+
+#ifdef SEARCH_GROUP_RESULTS_BY_DOCUMENT
+        /*
+        * A document only keeps its best paragraph, so that the threshold is the score of the SEARCH_TOP_K-th best document.
+        */
+        const auto document = topDocuments.find(entry.second.match->document_id);
+        if (document != topDocuments.end()) {
+            auto previous = find_if(topParagraphs.begin(), topParagraphs.end(), [&](const pair<int64_t, ParagraphScore<Policy>>& top) { return top.first == document->second; });
+
+            if (!rankParagraphs<Policy>(entry, *previous)) {
+                continue;
+            }
+            *previous = std::move(entry);
+            document->second = candidate;
+            make_heap(topParagraphs.begin(), topParagraphs.end(), rankParagraphs<Policy>);
+        } else
+#endif
+        {
+            if (topParagraphs.size() == SEARCH_TOP_K) {
+                pop_heap(topParagraphs.begin(), topParagraphs.end(), rankParagraphs<Policy>);
+#ifdef SEARCH_GROUP_RESULTS_BY_DOCUMENT
+                topDocuments.erase(topParagraphs.back().second.match->document_id);
+#endif
+                topParagraphs.back() = std::move(entry);
+            } else {
+                topParagraphs.push_back(std::move(entry));
+            }
+#ifdef SEARCH_GROUP_RESULTS_BY_DOCUMENT
+            topDocuments[topParagraphs.back().second.match->document_id] = topParagraphs.back().first;
+#endif
+            push_heap(topParagraphs.begin(), topParagraphs.end(), rankParagraphs<Policy>);
+        }
+
+        if (topParagraphs.size() == SEARCH_TOP_K) {
+            threshold = topParagraphs.front().second.score;
+
+            while (firstEssential < lists.size() && maxScoreSums[firstEssential] < threshold) {
+                firstEssential++;
+            }
+        }
+    }
+
+    return topParagraphs;
+}
+#else
+template<class Policy>
+inline ParagraphScoreList<Policy> Search::calculateParagraphScores(const vector<WordMatch>& matches, const vector<QueryPhrase>& phrases, const CancellationToken& Token) {
+    /*
+    * Indexed by paragraph id. Only the executor thread ranks paragraphs, and each instantiation (ranking policy) has its own.
+    */
+    static DenseAccumulator<ParagraphScore<Policy>> paragraphScores;
+    paragraphScores.Reset();
+    paragraphScores.Reserve(Database::ParagraphCount());
+
+    const CorpusStatistics corpus = corpusStatistics();
 
     for (const auto& wordMatch : matches) {
+        if (Token.isCancelled()) {
+            return {};
+        }
+
         for (const auto& exactMatch : wordMatch.exact_match_data) {
-            int64_t paragraphId = get<0>(exactMatch);
-            string originalText = get<1>(exactMatch);
-            paragraphScores[paragraphId].first.first++;
-            if (paragraphScores[paragraphId].second.empty()) {
-                paragraphScores[paragraphId].second = originalText;
+            ParagraphScore<Policy>& score = paragraphScores[exactMatch.paragraph_id];
+            score.exact_matches++;
+            score.score += Policy::ExactMatch(exactMatch, corpus);
+            if (!score.match) {
+                score.match = &exactMatch;
             }
         }
 
         for (const auto& partialMatch : wordMatch.partial_match_data) {
-            int64_t paragraphId = get<0>(partialMatch);
-            string originalText = get<1>(partialMatch);
-            paragraphScores[paragraphId].first.second++;
-            if (paragraphScores[paragraphId].second.empty()) {
-                paragraphScores[paragraphId].second = originalText;
+            ParagraphScore<Policy>& score = paragraphScores[partialMatch.paragraph_id];
+            score.partial_matches++;
+            score.score += Policy::PartialMatch(partialMatch, corpus);
+            if (!score.match) {
+                score.match = &partialMatch;
+            }
+        }
+
+        for (size_t i = 0; i < wordMatch.fuzzy_match_data.size(); ++i) {
+            const ParagraphMatch& fuzzyMatch = wordMatch.fuzzy_match_data[i];
+            ParagraphScore<Policy>& score = paragraphScores[fuzzyMatch.paragraph_id];
+            score.fuzzy_matches++;
+            score.score += Policy::FuzzyMatch(fuzzyMatch, wordMatch.fuzzy_match_distances[i], corpus);
+            if (!score.match) {
+                score.match = &fuzzyMatch;
             }
         }
     }
 
-    return paragraphScores;
-}
+    uint64_t phraseStarts = 0;
+    uint64_t phraseEnds = 0;
+    if (matches.size() >= 2) {
+        buildQueryWordMasks(matches, phrases, QueryWordMasks, phraseStarts, phraseEnds);
+    }
+
+    RoaringBitmap phraseParagraphs;
+    const bool hasPhrases = findPhraseParagraphs(matches, phrases, phraseParagraphs);
 
-inline bool Search::rankParagraphs(const pair<int64_t, pair<pair<int, int>, string>>& a, const pair<int64_t, pair<pair<int, int>, string>>& b) {
-    int exactA = a.second.first.first;
-    int partialA = a.second.first.second;
-    int exactB = b.second.first.first;
-    int partialB = b.second.first.second;
+    ParagraphScoreList<Policy> paragraphScoreList(&Arena);
+    paragraphScoreList.reserve(paragraphScores.Touched().size());
+
+    for (const int64_t paragraphId : paragraphScores.Touched()) {
+        if (hasPhrases && !phraseParagraphs.Contains(static_cast<uint32_t>(paragraphId))) {
+            continue;
+        }
 
-    if (exactA != exactB) {
-        return exactA > exactB;
+        ParagraphScore<Policy>& score = paragraphScores[paragraphId];
+
+        if (matches.size() >= 2) {
+            const uint64_t phrasesFound = scoreProximity(score.match->word_ids, QueryWordMasks, phraseStarts, phraseEnds, score.adjacent_words);
+
+            if (phrasesFound != phraseEnds) {
+                continue;
+            }
+            score.score += Policy::Proximity(score.adjacent_words);
+        }
+        paragraphScoreList.push_back({paragraphId, score});
     }
 
-    if (partialA != partialB) {
-        return partialA > partialB;
+    return paragraphScoreList;
+}
+#endif
+
+template<class Policy>
+inline bool Search::rankParagraphs(const pair<int64_t, ParagraphScore<Policy>>& a, const pair<int64_t, ParagraphScore<Policy>>& b) {
+    if (a.second.score != b.second.score) {
+        return a.second.score > b.second.score;
     }
 
-    return a.first < b.first;
+    return Policy::TieBreak(a, b);
 }
 
-inline vector<pair<int64_t, string>> Search::rankParagraphIds(const vector<WordMatch>& matches) {
-    unordered_map<int64_t, pair<pair<int, int>, string>> paragraphScores = calculateParagraphScores(matches);
+template<class Policy>
+inline pmr::vector<pair<int64_t, string_view>> Search::rankParagraphIds(const vector<WordMatch>& matches, const vector<QueryPhrase>& phrases, const CancellationToken& Token) {
+    ParagraphScoreList<Policy> paragraphScoreList = calculateParagraphScores<Policy>(matches, phrases, Token);
 
-    vector<pair<int64_t, pair<pair<int, int>, string>>> paragraphScoreList;
-    for (const auto& entry : paragraphScores) {
-        paragraphScoreList.push_back(entry);
+    if (Token.isCancelled()) {
+        return {};
     }
 
-    sort(paragraphScoreList.begin(), paragraphScoreList.end(), rankParagraphs);
+    sort(paragraphScoreList.begin(), paragraphScoreList.end(), rankParagraphs<Policy>);
 
-    vector<pair<int64_t, string>> rankedParagraphsWithText;
+    pmr::vector<pair<int64_t, string_view>> rankedParagraphsWithText(&Arena);
+    rankedParagraphsWithText.reserve(paragraphScoreList.size());
+#ifdef SEARCH_GROUP_RESULTS_BY_DOCUMENT
+    /*
+    * A long document is many paragraphs, which would otherwise fill the results with the same document.
+    * The list is already sorted, so the first paragraph of each document is its best one.
+    */
+    pmr::unordered_set<int64_t> rankedDocumentIds(&Arena);
+    for (const auto& entry : paragraphScoreList) {
+        if (rankedDocumentIds.insert(entry.second.match->document_id).second) {
+            rankedParagraphsWithText.push_back({entry.first, entry.second.match->original_text});
+        }
+    }
+#else
     for (const auto& entry : paragraphScoreList) {
-        rankedParagraphsWithText.push_back({entry.first, entry.second.second});
+        rankedParagraphsWithText.push_back({entry.first, entry.second.match->original_text});
     }
+#endif
 
     return rankedParagraphsWithText;
 }
 
+void Search::findPhrases()
+{
+    QueryPhrases.clear();
+
+    const char* text = QueryText.original_text.data();
+    const size_t size = QueryText.original_text_size;
+
+    size_t i = 0;
+    bool inside_quotes = false;
+
+    for (size_t w = 0; w < QueryText.wordCount(); ++w)
+    {
+        /*
+        * Quotes are separators, so they're never inside a word's original span. Whether the word is quoted only depends on the quotes before it.
+        */
+        const size_t word_offset = QueryText.original_word_spans[w].offset;
+        bool opened = false;
+
+        while (i < word_offset && i < size)
+        {
+            size_t length = 1;
+            bool is_quote = (text[i] == '"');
+
+            if (static_cast<unsigned char>(text[i]) >= 0x80)
+            {
+                uint32_t code_point;
+                const char* folded;
+                size_t folded_size;
+
+                length = max<size_t>(DecodeUtf8(text + i, size - i, code_point), 1);
+                is_quote = length > 1 && FoldCodePoint(code_point, folded, folded_size) && folded_size == 1 && folded[0] == '"';
+            }
+
+            if (is_quote)
+            {
+                inside_quotes = !inside_quotes;
+                opened |= inside_quotes;
+            }
+            i += length;
+        }
+
+        if (inside_quotes)
+        {
+            if (opened || QueryPhrases.empty() || QueryPhrases.back().last_word != w)
+            {
+                QueryPhrases.push_back(QueryPhrase{w, w + 1});
+            } else
+            {
+                QueryPhrases.back().last_word = w + 1;
+            }
+        }
+    }
+}
+
 int Search::searchBarInputCallback(ImGuiInputTextCallbackData* data) {
+    Executor->Submit(data->Buf, static_cast<size_t>(data->BufTextLen));
+
+    return 0; // means "don't make any modifications to the input"
+}
+
+const vector<string>& Search::PollResults()
+{
+    SearchResults.Update();
+    return SearchResults.Read();
+}
+
+void Search::runQuery(const string& query, const CancellationToken& Token)
+{
     Database* db = Database::Get();
 
     if (db->isValid())
@@ -198,105 +728,143 @@ int Search::searchBarInputCallback(ImGuiInputTextCallbackData* data) {
 
         t0  = chrono::high_resolution_clock::now();
 #endif
-        if (data->BufTextLen == 0)
+        Arena.Reset(); // nothing that the previous query allocated from it is used anymore
+
+        vector<string>& results = SearchResults.WriteBuffer();
+
+        /*
+        * Only the words around the text that changed since the previous query are re-normalized.
+        * The edit says which entries of SearchProgress they replace, so the matches of every other word are kept (and shifted along, if words were inserted or removed before them).
+        */
+        const TextEdit edit = QueryText.Edit(query.data(), query.size(), MAX_PARAGRAPH_SIZE);
+
+        if (edit.changed())
+        {
+            SearchProgress.erase(SearchProgress.begin() + edit.first_word, SearchProgress.begin() + edit.first_word + edit.removed_words);
+            SearchProgress.insert(SearchProgress.begin() + edit.first_word, edit.inserted_words, WordMatch("", {}, {}, 0.0)); // placeholders, filled in below
+        }
+
+        if (query.empty())
         {
             /*
             * The search bar does not contain any text.
             */
-            SearchProgress.clear();
-            SearchResults.clear();
+            results.clear();
+            SearchResults.Publish();
         } else
         {
             /*
             * There is text in the search bar.
+            * Either the user typed or deleted some characters, pasted a string of text to the search bar, or used autocorrect.
+            *
+            * SearchProgress[i] is the match for QueryText.word(i), unless it's a placeholder for a word that hasn't been queried yet (eg. its query was cancelled).
+            * A placeholder's normalized_word is empty, so it never equals the word, and only those words are queried.
+            *
+            * Stop words (eg. "the") are in most paragraphs, and are contained in many other words, so their partial matches add a lot of rows and little ranking signal.
+            * Only their exact matches are looked up, unless the stop word is still being typed (eg. "the" may become "theater").
+            * A stop word is queried again once it's complete, to drop its partial matches.
+            *
+            * Likewise, a word that isn't in the vocabulary is usually just not typed out yet (eg. "summ"), rather than a typo, so while it's being typed,
+            * its fuzzy matches are only looked up if it has no partial matches (eg. "sumit"). If they were skipped, it's queried again once it's complete.
+            * They're kept if the word becomes incomplete again (eg. its trailing space is deleted).
             */
-            if (SearchProgress.empty())
-            {
-                /*
-                * This is the start of a new search.
-                * Either the user typed the first character in their search, or pasted a string of text to the search bar.
-                */
-                const NormalizedText normalized_text(data->Buf, MAX_PARAGRAPH_SIZE);
-
-                const size_t nWords = normalized_text.normalized_words.size();
+            const NormalizedText& normalized_text = QueryText;
+            const size_t nWords = normalized_text.wordCount();
 
-                for (size_t i = 0; i < nWords; ++i)
-                {
-                    const string& normalized_word = normalized_text.normalized_words[i];
-                    SearchProgress.push_back(getMatches(db, normalized_word));
-                }
-            } else
+            for (size_t i = 0; i < nWords; ++i)
             {
-                /*
-                * The user is continuing their search.
-                * Either they typed the next character in their search, or pasted a string of text to the search bar, or used autocorrect.
-                */
-                const NormalizedText normalized_text(data->Buf, MAX_PARAGRAPH_SIZE);
+                const string_view normalized_word = normalized_text.word(i);
+                const bool is_complete = i + 1 < nWords || normalized_text.isLastWordComplete();
+                const bool skip_partial_matches = normalized_text.isStopWord(i) && is_complete;
 
-                const size_t nWords = normalized_text.normalized_words.size();
-                const size_t nWordMatches = SearchProgress.size();
-
-                for (size_t i = 0; i < nWords; ++i)
+                if (normalized_word != SearchProgress[i].normalized_word || skip_partial_matches != SearchProgress[i].partial_matches_skipped || (is_complete && SearchProgress[i].fuzzy_matches_skipped))
                 {
-                    const string& normalized_word = normalized_text.normalized_words[i];
+                    const WordMatch match = getMatches(db, normalized_word, skip_partial_matches, !is_complete, Token);
 
-                    if (i < nWordMatches)
-                    {
-                        if (normalized_word != SearchProgress[i].normalized_word)
-                        {
-                            const WordMatch match = getMatches(db, normalized_word);
-                            SearchProgress[i] = match;
-                        }
-                    } else
+                    if (Token.isCancelled())
                     {
-                        SearchProgress.push_back(getMatches(db, normalized_word));
+                        return; // SearchProgress only holds complete matches, so the next query continues from here
                     }
-                }
-
-                for (size_t i = nWords; i < nWordMatches; ++i)
-                {
-                    SearchProgress.pop_back();
+                    SearchProgress[i] = match;
                 }
             }
 
-            vector<int64_t> exact_word_match_ids = {};
-            for (const WordMatch& match : SearchProgress)
+            findPhrases();
+
+            const pmr::vector<pair<int64_t, string_view>> rankedParagraphIds = rankParagraphIds<RankingPolicy>(SearchProgress, QueryPhrases, Token);
+
+            if (Token.isCancelled())
             {
-                if (match.foundExactMatch())
-                {
-                    exact_word_match_ids.push_back(match.exact_match_idx);
-                }
+                return; // a newer query will publish its own results
             }
-
-            const vector<pair<int64_t, string>> rankedParagraphIds = rankParagraphIds(SearchProgress);
-            SearchResults.clear();
-            SearchResults.reserve(rankedParagraphIds.size());
-            for (const auto& entry : rankedParagraphIds) {
-                SearchResults.push_back(entry.second);
+            /*
+            * The strings are assigned rather than rebuilt, so they reuse the memory of the results that were last written to this buffer.
+            */
+            results.resize(rankedParagraphIds.size());
+            for (size_t i = 0; i < rankedParagraphIds.size(); ++i) {
+                results[i].assign(rankedParagraphIds[i].second);
             }
+            SearchResults.Publish();
 
 
 #ifdef SEARCH_LOG_EXECUTION_TIMES
-            cout << "\nsearchBarInputCallback() - Query itteration report:" << endl;
+            cout << "\nrunQuery() - Query itteration report (generation " << Token.generation << "):" << endl;
             t1  = chrono::high_resolution_clock::now();
             auto duration = chrono::duration_cast<chrono::microseconds>(t1 - t0);
             cout << "Time taken to search the database: " << duration.count() << " microseconds" << endl;
+            cout << "Queries run: " << Executor->QueriesRun() << " of " << Executor->LatestGeneration() << " edits, debounce window: " << Executor->DebounceWindowUs() << " microseconds" << endl;
 #endif
 #ifdef SEARCH_LOG_DEBUG_MESSAGES
             cout << "Words in query: " << endl;
             for(const WordMatch& match : SearchProgress)
             {
-                cout << "  '" << match.normalized_word.c_str() << "' - Exact Word Matches: " << (match.foundExactMatch() ? "1" : "0") << ", Partial Word Matches: " << match.partial_match_idxs.size() << endl;
+                cout << "  '" << match.normalized_word.c_str() << "' - Exact Word Matches: " << (match.foundExactMatch() ? "1" : "0") << ", Partial Word Matches: " << match.partial_match_idxs.size() << ", Fuzzy Word Matches: " << match.fuzzy_match_idxs.size() << endl;
                 cout << "     Number of paragraphs containing an exact match: " << match.exact_match_data.size() << endl;
                 cout << "     Number of paragraphs containing a partial match: " << match.partial_match_data.size() << endl;
+                cout << "     Number of paragraphs containing a fuzzy match: " << match.fuzzy_match_data.size() << endl;
             }
+            for (const QueryPhrase& phrase : QueryPhrases)
+            {
+                cout << "  Phrase: words " << phrase.first_word << " to " << phrase.last_word - 1 << endl;
+            }
+            if (!QueryPhrases.empty())
+            {
+                cout << "  Phrase candidates intersected with the " << IntersectSortedVariant() << " kernel" << endl;
+            }
+#ifdef SEARCH_LOG_PARAGRAPH_SET_STATISTICS
+            if (!SearchProgress.empty())
+            {
+                RoaringBitmap any_word = SearchProgress[0].ParagraphSet();
+                RoaringBitmap every_word = any_word;
+                for (size_t i = 1; i < SearchProgress.size(); ++i)
+                {
+                    const RoaringBitmap paragraphs = SearchProgress[i].ParagraphSet();
+                    any_word.Or(paragraphs);
+                    every_word.And(paragraphs);
+                }
+                cout << "  Paragraphs containing any word: " << any_word.Cardinality() << ", every word: " << every_word.Cardinality() << endl;
+            }
+#endif
+            cout << "  Query arena: " << Arena.BytesUsed() << " of " << Arena.Capacity() << " bytes used" << endl;
             cout << "\n" <<endl;
 # endif
+#ifdef SEARCH_LOG_THREADPOOL_TELEMETRY
+            const ThreadPoolTelemetry telemetry = PoolTelemetry();
+            const LatencyHistogram interactive_wait = telemetry.QueueWait(PRIORITY_INTERACTIVE);
+            const LatencyHistogram execution = telemetry.Execution();
+
+            cout << "Thread pool telemetry: " << endl;
+            cout << "  Queue depth (interactive, normal, background): " << telemetry.queue_depth[PRIORITY_INTERACTIVE] << ", " << telemetry.queue_depth[PRIORITY_NORMAL] << ", " << telemetry.queue_depth[PRIORITY_BACKGROUND] << endl;
+            cout << "  Interactive queue wait: mean " << interactive_wait.Mean() << " ns, p50 <= " << interactive_wait.Percentile(0.5) << " ns, p99 <= " << interactive_wait.Percentile(0.99) << " ns, max " << interactive_wait.max_ns << " ns" << endl;
+            cout << "  Execution: mean " << execution.Mean() << " ns, p50 <= " << execution.Percentile(0.5) << " ns, p99 <= " << execution.Percentile(0.99) << " ns, max " << execution.max_ns << " ns" << endl;
+            for (size_t w = 0; w < telemetry.workers.size(); ++w)
+            {
+                cout << "  Worker " << w << ": " << telemetry.workers[w].tasks_run[PRIORITY_INTERACTIVE] << " interactive tasks, utilization " << telemetry.workers[w].Utilization() * 100.0 << "%" << endl;
+            }
+#endif
         }
     } else
     {
-        cerr << "searchBarInputCallback() - Did not run search because database is invalid." << endl;
+        cerr << "runQuery() - Did not run search because database is invalid." << endl;
     }
-
-    return 0; // means "don't make any modifications to the input"
 }
@@ -2,21 +2,67 @@
 
 #define SEARCH_LOG_EXECUTION_TIMES                  // uncomment this line to log execution times to the console
 #define SEARCH_LOG_DEBUG_MESSAGES                   // uncomment this line to log debug messages to the console
+// #define SEARCH_LOG_PARAGRAPH_SET_STATISTICS         // uncomment this line to also log the number of paragraphs that contain any and every word of the query, which combines their paragraph sets on every keystroke
+// #define SEARCH_LOG_THREADPOOL_TELEMETRY             // uncomment this line to log the thread pool's queue depth, wait and run times to the console after each query
 // #define SEARCH_CHECK_FOR_ASSUMED_IMPOSSIBLE_ERRORS  // checks for errors that should, theoretically, never happen
+#define SEARCH_GROUP_RESULTS_BY_DOCUMENT            // comment out this line to list every matching paragraph, instead of only the best paragraph of each document
+#define SEARCH_RANKING_POLICY BM25RankingPolicy     // how search results are ranked, see ranking_policy.h. eg. MatchCountRankingPolicy ranks by the number of matched words
+#define SEARCH_TOP_K (static_cast<size_t>(100))     // comment out this line to score every paragraph that matches any word of the query, instead of only finding the best SEARCH_TOP_K
+#define SEARCH_TOP_K_CANCELLATION_CHECK_INTERVAL 256 // number of candidate paragraphs scored between checks of the query's cancellation token
+#define SEARCH_PROXIMITY_MAX_QUERY_WORDS (static_cast<size_t>(64))  // the query words are tracked as the bits of a uint64_t, so words after the 64th don't count towards proximity or phrases
+#define SEARCH_FUZZY_MIN_WORD_SIZE_1 (static_cast<size_t>(4))     // a word of at least this many bytes that isn't in the vocabulary also matches the words 1 edit away from it. Shorter words are 1 edit away from too many words
+#define SEARCH_FUZZY_MIN_WORD_SIZE_2 (static_cast<size_t>(8))     // ... and 2 edits away
 
 #include <vector>
+#include <unordered_set>
+#include <memory_resource>
 
 #include "database.h"
 #include "linux_threadpool.h"
+#include "search_executor.h"
+#include "ranking_policy.h"
 
 #include "Structures/NormalizedText.h"
 #include "Structures/WordMatch.h"
+#include "Structures/TripleBuffer.h"
+#include "Structures/DenseAccumulator.h"
+#include "Structures/QueryArena.h"
 
 #include "../extern/imgui/imgui.h"
 
 
 using namespace std;
 
+typedef SEARCH_RANKING_POLICY RankingPolicy;
+
+/*
+* Paragraph ids and their scores, allocated from Search::Arena.
+*/
+template<class Policy>
+using ParagraphScoreList = pmr::vector<pair<int64_t, ParagraphScore<Policy>>>;
+
+/*
+* A position in the paragraphs of one word's exact, partial or fuzzy matches (which are ordered by paragraph id), for top-K ranking.
+*/
+template<class Policy>
+struct PostingCursor
+{
+    const vector<ParagraphMatch>* postings;
+    WordMatchClass match_class;
+    const vector<uint8_t>* distances;   // the distance of each posting's word, for FUZZY_WORD_MATCH. Otherwise nullptr
+    typename Policy::Score max_score;   // no paragraph gets more than this from this list
+    PostingList::Cursor position;       // over the WordMatch's paragraph ids of the same class. position.Index() is the index of the paragraph in postings
+};
+
+/*
+* A quoted phrase of the query, as the words [first_word, last_word) of Search::QueryText.
+*/
+struct QueryPhrase
+{
+    size_t first_word;
+    size_t last_word;
+};
+
 class Search {
 private:
     Search();
@@ -29,22 +75,105 @@ public:
 
     static void Destroy();
 
-    static inline const WordMatch getMatches(Database* db_prechecked, const string& normalized_word);
-
-    static inline unordered_map<int64_t, pair<pair<int, int>, string>> calculateParagraphScores(const vector<WordMatch>& matches);
-
-    static inline bool rankParagraphs(const pair<int64_t, pair<pair<int, int>, string>>& a, const pair<int64_t, pair<pair<int, int>, string>>& b);
+    /*
+    * If SkipPartialMatches is true, only the exact match is looked up.
+    * Fuzzy matches are only looked up for a word that isn't in the vocabulary (and isn't a stop word), so a typo still finds something,
+    * unless SkipFuzzyMatches is true (the word is still being typed) and the word has partial matches.
+    * If Token is cancelled while this runs, the returned WordMatch is incomplete and must be discarded.
+    */
+    static inline const WordMatch getMatches(Database* db_prechecked, const string_view normalized_word, const bool SkipPartialMatches, const bool SkipFuzzyMatches, const CancellationToken& Token);
+
+    /*
+    * The corpus statistics that the ranking policy scores paragraphs with.
+    */
+    static inline CorpusStatistics corpusStatistics();
+
+    /*
+    * One pass over the paragraph's words. query_word_masks maps each matched word id to the query words that it matches (bit j for SearchProgress[j]).
+    * Counts the pairs of consecutive query words that occur next to each other, and returns the bits of phrase_ends whose phrase occurs in the paragraph.
+    */
+    static inline uint64_t scoreProximity(const vector<int64_t>& word_ids, const DenseAccumulator<uint64_t>& query_word_masks, const uint64_t phrase_starts, const uint64_t phrase_ends, int& adjacent_words);
+
+    /*
+    * Sets bit j of query_word_masks[id] for each word id that is an exact, partial or fuzzy match of query word j, and the bits of the first and last word of each phrase.
+    */
+    static inline void buildQueryWordMasks(const vector<WordMatch>& matches, const vector<QueryPhrase>& phrases, DenseAccumulator<uint64_t>& query_word_masks, uint64_t& phrase_starts, uint64_t& phrase_ends);
+
+    /*
+    * The paragraphs that contain a match of every word of every phrase, ie. the intersection of those words' paragraph ids (with IntersectSorted(), see SortedSetKernels.h).
+    * Only these paragraphs can contain the phrases, so the others are skipped before they're scored. Returns false if there are no phrases.
+    * The words' paragraph ids are only decoded here, for the words of a phrase, so a query without phrases never decodes them.
+    */
+    static inline bool findPhraseParagraphs(const vector<WordMatch>& matches, const vector<QueryPhrase>& phrases, RoaringBitmap& phrase_paragraphs);
+
+    /*
+    * Paragraphs that don't contain every phrase are left out.
+    *
+    * If SEARCH_TOP_K is defined, only the best SEARCH_TOP_K paragraphs (or documents, with SEARCH_GROUP_RESULTS_BY_DOCUMENT) are returned.
+    * They are found with MaxScore: once there are SEARCH_TOP_K results, a paragraph that's only in the lists whose max scores add up to
+    * less than the worst result can't make it, so those lists are only probed for paragraphs found in the other lists, instead of being walked.
+    * This only prunes the ranking pass: a broad partial match (eg. "s") is still fetched from the database in full by getMatches(),
+    * but next to a selective word, few of its paragraphs are scored.
+    */
+    template<class Policy>
+    static inline ParagraphScoreList<Policy> calculateParagraphScores(const vector<WordMatch>& matches, const vector<QueryPhrase>& phrases, const CancellationToken& Token);
+
+    /*
+    * True if a ranks before b: the higher score, or Policy::TieBreak() if the scores are equal.
+    */
+    template<class Policy>
+    static inline bool rankParagraphs(const pair<int64_t, ParagraphScore<Policy>>& a, const pair<int64_t, ParagraphScore<Policy>>& b);
+
+    /*
+    * The ranked paragraph ids and their text. Allocated from Arena, and the text points into matches, so the list is only valid until the next query.
+    */
+    template<class Policy>
+    static inline pmr::vector<pair<int64_t, string_view>> rankParagraphIds(const vector<WordMatch>& matches, const vector<QueryPhrase>& phrases, const CancellationToken& Token);
+
+    /*
+    * Runs on the render loop. Hands the search bar's text to the search executor and returns immediately.
+    */
+    static int searchBarInputCallback(ImGuiInputTextCallbackData* data);
 
-    static inline vector<pair<int64_t, string>> rankParagraphIds(const vector<WordMatch>& matches);
+    /*
+    * Runs on the render loop, once per frame. Picks up the results of the most recently completed query (if there is one) without blocking.
+    * The returned reference stays valid until the next call.
+    */
+    static const vector<string>& PollResults();
 
-    static int searchBarInputCallback(ImGuiInputTextCallbackData* data);
+    /*
+    * A snapshot of the search thread pool's counters, for the app and benchmarks to sample.
+    */
+    static ThreadPoolTelemetry PoolTelemetry() { return Pool ? Pool->Sample() : ThreadPoolTelemetry(); }
 
     static char               SearchBarBuffer[MAX_PARAGRAPH_SIZE];
-    static vector<string>     SearchResults;
 
 protected:
+    /*
+    * Runs on the search executor's thread, which is the only thread that touches SearchProgress and the database's main thread connection after initialization.
+    */
+    static void runQuery(const string& query, const CancellationToken& Token);
+
+    /*
+    * Finds the phrases in double quotes (ASCII or curly) of QueryText, and stores them in QueryPhrases.
+    * A phrase that hasn't been closed yet runs to the end of the query, so that it's matched while it's being typed.
+    */
+    static void findPhrases();
+
     static Search*            Instance;
     static vector<WordMatch>  SearchProgress;
+    static NormalizedText     QueryText;        // reused by every query, so normalizing a keystroke's text doesn't allocate
+    static vector<QueryPhrase> QueryPhrases;
+    static DenseAccumulator<uint64_t> QueryWordMasks;   // word id -> the query words that it matches, see buildQueryWordMasks()
+
+    /*
+    * The allocations that only live for one query (ranking cursors, heaps and result lists). Reset at the start of each query,
+    * after the previous query's results have been copied to SearchResults, so a keystroke's ranking doesn't call malloc or free.
+    */
+    static QueryArena         Arena;
+
+    static TripleBuffer<vector<string>> SearchResults;
 
     static ThreadPool*        Pool;
+    static SearchExecutor*    Executor;
 };
\ No newline at end of file
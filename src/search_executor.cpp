@@ -0,0 +1,189 @@
+#include <iostream>
+#include <algorithm>
+#include <time.h>
+
+#include "search_executor.h"
+
+SearchExecutor::SearchExecutor(function<void(const string&, const CancellationToken&)> Run) : 
+    run{Run}, stop{false}, joined{false}, pending_query{""}, has_pending_query{false}, first_edit_ns{0}, last_edit_ns{0}, latest_generation{0}, 
+    queries_run{0}, debounce_window_ns{SEARCH_EXECUTOR_DEBOUNCE_MIN_US * 1000}, average_latency_ns{0.0}
+{
+    int rc;
+
+    rc = pthread_mutex_init(&mutex, nullptr);
+    if (rc != 0)
+    {
+        cerr << "SearchExecutor::SearchExecutor() - ERROR: Error initializing pthread mutex." << endl;
+        exit(EXIT_FAILURE);
+    }
+
+    /*
+    * The debounce deadlines are measured with CLOCK_MONOTONIC, so the condition's timed waits must use the same clock.
+    */
+    pthread_condattr_t condition_attr;
+
+    rc = pthread_condattr_init(&condition_attr);
+    if (rc != 0)
+    {
+        cerr << "SearchExecutor::SearchExecutor() - ERROR: Error initializing pthread condition attributes." << endl;
+        exit(EXIT_FAILURE);
+    }
+
+    rc = pthread_condattr_setclock(&condition_attr, CLOCK_MONOTONIC);
+    if (rc != 0)
+    {
+        cerr << "SearchExecutor::SearchExecutor() - ERROR: Error setting pthread condition clock." << endl;
+        exit(EXIT_FAILURE);
+    }
+
+    rc = pthread_cond_init(&condition, &condition_attr);
+    if (rc != 0)
+    {
+        cerr << "SearchExecutor::SearchExecutor() - ERROR: Error initializing pthread condition." << endl;
+        exit(EXIT_FAILURE);
+    }
+
+    pthread_condattr_destroy(&condition_attr);
+
+    rc = pthread_create(&thread, nullptr, &SearchExecutor::LoopThread, this);
+    if (rc != 0)
+    {
+        cerr << "SearchExecutor::SearchExecutor() - ERROR: Error creating thread." << endl;
+        exit(EXIT_FAILURE);
+    }
+}
+
+SearchExecutor::~SearchExecutor()
+{
+    StopThread();
+
+    pthread_cond_destroy(&condition);
+    pthread_mutex_destroy(&mutex);
+}
+
+uint64_t SearchExecutor::Submit(const char* text, const size_t size)
+{
+    uint64_t generation;
+    {
+        pthread_mutex_lock(&mutex);
+
+        pending_query.assign(text, size);
+
+        last_edit_ns = Now();
+        if (!has_pending_query)
+        {
+            first_edit_ns = last_edit_ns;
+        }
+        has_pending_query = true;
+        generation = latest_generation.load(memory_order_relaxed) + 1;
+        latest_generation.store(generation, memory_order_release);
+    }
+    pthread_mutex_unlock(&mutex);
+    pthread_cond_signal(&condition);
+    return generation;
+}
+
+void SearchExecutor::StopThread()
+{
+    pthread_mutex_lock(&mutex);
+    stop = true;
+    latest_generation.fetch_add(1, memory_order_release); // cancels the query in flight (if any), so that joining doesn't wait for it to finish
+    pthread_mutex_unlock(&mutex);
+    pthread_cond_signal(&condition);
+
+    if (!joined)
+    {
+        pthread_join(thread, nullptr);
+        joined = true;
+    }
+}
+
+void* SearchExecutor::LoopThread(void* args)
+{
+    SearchExecutor* executor = static_cast<SearchExecutor*>(args);
+
+    string query = "";
+    uint64_t generation = 0;
+
+    while (true)
+    {
+        {
+            pthread_mutex_lock(&executor->mutex);
+
+            while (!executor->has_pending_query && !executor->stop)
+            {
+                pthread_cond_wait(&executor->condition, &executor->mutex);
+            }
+
+            /*
+            * Coalesce edits: wait until no edit has arrived for the debounce window, but never longer than SEARCH_EXECUTOR_MAX_DELAY_US after the first edit.
+            * Every Submit() wakes this wait, and pushes the deadline back.
+            */
+            const int64_t window_ns = executor->debounce_window_ns.load(memory_order_relaxed);
+
+            while (!executor->stop && window_ns > 0)
+            {
+                const int64_t deadline_ns = min(executor->last_edit_ns + window_ns, executor->first_edit_ns + SEARCH_EXECUTOR_MAX_DELAY_US * 1000);
+
+                if (Now() >= deadline_ns)
+                {
+                    break;
+                }
+
+                const timespec deadline = { static_cast<time_t>(deadline_ns / 1000000000), static_cast<long>(deadline_ns % 1000000000) };
+                pthread_cond_timedwait(&executor->condition, &executor->mutex, &deadline);
+            }
+
+            if (executor->stop)
+            {
+                pthread_mutex_unlock(&executor->mutex);
+                return nullptr;
+            }
+
+            query.swap(executor->pending_query); // swap instead of copy, so that both strings keep their capacity
+            generation = executor->latest_generation.load(memory_order_relaxed);
+            executor->has_pending_query = false;
+
+            pthread_mutex_unlock(&executor->mutex);
+        }
+
+        const CancellationToken token(executor->latest_generation, generation);
+        const int64_t t0 = Now();
+
+        executor->queries_run.fetch_add(1, memory_order_relaxed); // before run(), so that the query counts itself when it logs QueriesRun()
+        executor->run(query, token);
+
+        const int64_t latency_ns = Now() - t0;
+
+        /*
+        * A cancelled query stopped early, so its latency is only a lower bound of how long it would have taken.
+        * It still counts when it's above the average, otherwise queries that keep getting cancelled could never widen the window.
+        */
+        if (!token.isCancelled() || static_cast<double>(latency_ns) > executor->average_latency_ns)
+        {
+            executor->RecordLatency(latency_ns);
+        }
+    }
+    return nullptr;
+}
+
+int64_t SearchExecutor::Now()
+{
+    timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return static_cast<int64_t>(now.tv_sec) * 1000000000 + static_cast<int64_t>(now.tv_nsec);
+}
+
+void SearchExecutor::RecordLatency(const int64_t latency_ns)
+{
+    if (average_latency_ns == 0.0)
+    {
+        average_latency_ns = static_cast<double>(latency_ns);
+    } else
+    {
+        average_latency_ns += SEARCH_EXECUTOR_LATENCY_EWMA_WEIGHT * (static_cast<double>(latency_ns) - average_latency_ns);
+    }
+
+    const int64_t window_ns = static_cast<int64_t>(average_latency_ns * SEARCH_EXECUTOR_DEBOUNCE_LATENCY_FACTOR);
+    debounce_window_ns.store(clamp<int64_t>(window_ns, SEARCH_EXECUTOR_DEBOUNCE_MIN_US * 1000, SEARCH_EXECUTOR_DEBOUNCE_MAX_US * 1000), memory_order_relaxed);
+}
@@ -0,0 +1,92 @@
+#pragma once
+
+#include <pthread.h>
+#include <atomic>
+#include <string>
+#include <functional>
+
+#include "Structures/CancellationToken.h"
+
+#define SEARCH_EXECUTOR_DEBOUNCE_LATENCY_FACTOR 0.5     // the debounce window is this fraction of the recent average query latency
+#define SEARCH_EXECUTOR_DEBOUNCE_MIN_US 0               // lower bound of the debounce window
+#define SEARCH_EXECUTOR_DEBOUNCE_MAX_US 30000           // upper bound of the debounce window
+#define SEARCH_EXECUTOR_MAX_DELAY_US 60000              // a query always starts within this long of the first edit that it contains, no matter how fast the user types
+#define SEARCH_EXECUTOR_LATENCY_EWMA_WEIGHT 0.25        // weight of the latest completed query in the average query latency
+
+using namespace std;
+
+/*
+* Runs queries on a dedicated thread, so that no query (however slow) can stall the render loop.
+*
+* Submit() only copies the query into a mailbox and wakes the executor thread; it never waits for a query to finish.
+* The mailbox holds a single query: if the user types faster than queries complete, the intermediate states are replaced
+* by newer ones before they ever run, and the executor always runs the latest state next.
+*
+* Edits are also coalesced before a query starts: the executor waits until no edit has arrived for the length of the debounce window.
+* The window follows the recent query latency, so it is ~0 while queries are fast, and grows when a query would likely be
+* cancelled by the next keystroke anyways (eg. pasting, autocorrect, fast typing with slow queries). 
+* The wait is capped at SEARCH_EXECUTOR_MAX_DELAY_US after the first pending edit, which bounds the time to results.
+*/
+class SearchExecutor {
+public:
+    /*
+    * Run(query, token) is called on the executor thread, once per query that it picks up.
+    * The token's generation increases by one with every call to Submit(), and the token is cancelled by the next call to Submit().
+    */
+    SearchExecutor(function<void(const string&, const CancellationToken&)> Run);
+
+    SearchExecutor(const SearchExecutor&) = delete;
+    SearchExecutor& operator=(const SearchExecutor&) = delete;
+
+    ~SearchExecutor();
+
+    /*
+    * Returns the generation of the submitted query.
+    */
+    uint64_t Submit(const char* text, const size_t size);
+
+    /*
+    * The generation of the most recently submitted query. Safe to call from any thread.
+    */
+    uint64_t LatestGeneration() const { return latest_generation.load(memory_order_acquire); }
+
+    /*
+    * The number of queries that actually ran, including the one that is running. LatestGeneration() - QueriesRun() edits were coalesced away. Safe to call from any thread.
+    */
+    uint64_t QueriesRun() const { return queries_run.load(memory_order_relaxed); }
+
+    /*
+    * The current debounce window in microseconds. Safe to call from any thread.
+    */
+    int64_t DebounceWindowUs() const { return debounce_window_ns.load(memory_order_relaxed) / 1000; }
+
+    void StopThread();
+
+protected:
+    function<void(const string&, const CancellationToken&)> run;
+
+    pthread_t thread;
+    pthread_mutex_t mutex;
+    pthread_cond_t condition;
+    bool stop;
+    bool joined;
+
+    string pending_query;       // guarded by mutex
+    bool has_pending_query;     // guarded by mutex
+    int64_t first_edit_ns;      // guarded by mutex - time of the first Submit() since the executor last picked up a query
+    int64_t last_edit_ns;       // guarded by mutex - time of the latest Submit()
+    atomic<uint64_t> latest_generation;
+
+    atomic<uint64_t> queries_run;
+    atomic<int64_t> debounce_window_ns;
+    double average_latency_ns;  // executor thread only
+
+    static void* LoopThread(void* args);
+
+    /*
+    * CLOCK_MONOTONIC, in nanoseconds.
+    */
+    static int64_t Now();
+
+    void RecordLatency(const int64_t latency_ns);
+};